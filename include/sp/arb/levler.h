@@ -2,6 +2,7 @@
 #define LEVLER_H
 #include <sp/gxsp/texture.h>
 #include <sp/gxsp/transformable.h>
+#include <sp/gxsp/sprite.h>
 #include <sp/arb/overlay.h>
 #include <sp/math/vec.h>
 #include <sp/string.h>
@@ -39,6 +40,7 @@ namespace sp
             explicit            Levler();
                                ~Levler();
             void                loadRuleSet(const char* path);
+            void                loadRuleSet(const void* data, size_t length);
             void                loadLevel(const void* data);
             void                setSourceTexture(const Texture& texture);
             void                setDrawableUnitLength(unsigned int length);
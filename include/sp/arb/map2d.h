@@ -21,6 +21,7 @@ namespace sp
             //parser..
                                     Map2D();
             void                    loadRuleSet(const char* path);
+            void                    loadRuleSet(const void* data, size_t length);
             void                    loadLevel(const void* data);
             void                    setTextureAtlas(const Texture& texture);
             void                    markAsDrawable(unsigned int token);
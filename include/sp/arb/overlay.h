@@ -1,20 +1,22 @@
 #ifndef OVERLAY_H
 #define OVERLAY_H
 #include <sp/gxsp/drawable.h>
-#include <sp/gxsp/sprite.h>
+#include <sp/gxsp/texture.h>
+#include <vector>
 #include <memory>
 
 namespace sp
 {
-    //helper class for owning a drawable..
-    //the idea is that this class will maintain one vector for a series
-    //of drawables, reducing costs of performing numerous allocations
-    //for a crowded amount of drawables..
-
-    //of course, each element must have the properties of an actual drawable..
-    //this class must effectively emulate this feature..
-
-    //intended for multiple overlay drawable objects..
+    /**
+     *  many textured quads as one drawable, so one renderer entry..
+     *
+     *  quads are kept as structure of arrays (positions, sizes, texture rects,
+     *  colors, visibility) next to the four vertices each one owns. per quad
+     *  setters only rewrite those four vertices; uniformTranslate moves the
+     *  drawable itself. all quads share the texture of the first one.
+     *
+     *  positions are relative to the batch origin as it was when they were set..
+     */
     class SP_API SpriteBatch : public Drawable
     {
         public:
@@ -22,10 +24,13 @@ namespace sp
             typedef std::shared_ptr<const SpriteBatch>  ConstPtr;
 
             static Ptr                  create();
+
+            //returns the index of the quad or -1..
             int                         addQuad(const Texture& texture,
                                                 const vec2f& pos,
                                                 const vec2f& size = {},
                                                 const recti& area = recti{});
+            void                        reserve(size_t count);
 
             void                        uniformTranslate(const vec2f& pos);
             void                        uniformTranslate(float x, float y);
@@ -38,19 +43,26 @@ namespace sp
             bool                        isVisible(int index) const;
             void                        setVisible(int index, bool visible);
 
-            const Sprite&               get(int index) const;
-            Sprite&                     get(int index);
+            vec2f                       getPosition(int index) const;
+            vec2f                       getSize(int index) const;
+            Color                       getColor(int index) const;
 
             size_t                      size() const;
 
         private:
                                         SpriteBatch();
-            virtual void addDrawable(Renderer& renderer, bool max = false) override;
-            virtual void removeDrawable(Renderer& renderer) override;
-            std::vector<Sprite>         m_sprites;
 
-            //std::vector<DrawStates>     m_drawStates;
-            mutable DrawableStates      m_draw_states;
+            bool                        valid(int index) const;
+            void                        writePositions(size_t index);
+            void                        writeTexCoords(size_t index);
+            void                        writeColors(size_t index);
+            void                        publish();
+
+            std::vector<vec2f>          m_positions;
+            std::vector<vec2f>          m_sizes;
+            std::vector<rectf>          m_tex_rects;
+            std::vector<Color>          m_colors;
+            std::vector<SPuint8>        m_visible;
             vec2f                       m_origin;
     };
 }
@@ -1,9 +1,13 @@
 #ifndef DEFAULT_H
 #define DEFAULT_H
+#include <cstddef>
 
 namespace sp
 {
-    const void* loadDefaultFont();
+    struct SP_Baked_Font;
+
+    const void* loadDefaultFont(size_t* size = nullptr);
+    const SP_Baked_Font* loadDefaultBakedFont();
     const void* loadDefaultIcon();
 }
 
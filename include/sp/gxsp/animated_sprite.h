@@ -0,0 +1,118 @@
+#ifndef ANIMATED_SPRITE_H
+#define ANIMATED_SPRITE_H
+#include <sp/gxsp/sprite.h>
+#include <sp/math/rect.h>
+#include <memory>
+#include <vector>
+
+namespace sp
+{
+    /**
+     *  frames of a sprite sheet, defined once and shared by every sprite
+     *  playing the clip. texture coordinates are resolved when a frame is
+     *  added, so playing a clip never touches the texture..
+     */
+    class SP_API AnimationClip
+    {
+        public:
+            typedef std::shared_ptr<AnimationClip>          Ptr;
+            typedef std::shared_ptr<const AnimationClip>    ConstPtr;
+
+            static Ptr          create(const Texture& texture, float frame_time, bool loop = true);
+
+            void                addFrame(const recti& area);
+
+            //count frames of the size of first, left to right in rows of columns..
+            void                addFrames(const recti& first, unsigned int count, unsigned int columns);
+
+            size_t              getFrameCount() const;
+            const recti&        getFrameRect(size_t frame) const;
+
+            //normalized left, top, right, bottom..
+            const rectf&        getTexCoords(size_t frame) const;
+            const Texture&      getTexture() const;
+            float               getFrameTime() const;
+            float               getDuration() const;
+            bool                isLooping() const;
+
+            //the frame shown at time, clamped to the last frame unless looping..
+            size_t              getFrameAt(float time) const;
+
+        private:
+                                AnimationClip(const Texture& texture, float frame_time, bool loop);
+
+            const Texture&      m_texture;
+            std::vector<recti>  m_rects;
+            std::vector<rectf>  m_tex_coords;
+            float               m_frame_time;
+            bool                m_loop;
+    };
+
+    class AnimatedSprite;
+
+    /**
+     *  advances every attached sprite in one pass..
+     *
+     *  the per-sprite state (clip, time, speed, frame) lives here as
+     *  structure of arrays; sprites only get new texture coordinates when
+     *  their frame actually changed.
+     */
+    class SP_API Animator
+    {
+        public:
+                                Animator();
+                               ~Animator();
+
+                                Animator(const Animator&) = delete;
+            Animator&           operator=(const Animator&) = delete;
+
+            void                update(float delta_seconds);
+            size_t              size() const;
+
+        private:
+            friend class AnimatedSprite;
+
+            size_t              attach(AnimatedSprite* sprite);
+            void                detach(size_t slot);
+
+            std::vector<AnimatedSprite*>        m_sprites;
+            std::vector<const AnimationClip*>   m_clips;
+            std::vector<float>                  m_times;
+            std::vector<float>                  m_speeds;
+            std::vector<unsigned int>           m_frames;
+            std::vector<size_t>                 m_changed;
+    };
+
+    class SP_API AnimatedSprite : public Sprite
+    {
+        public:
+            typedef std::shared_ptr<AnimatedSprite>         Ptr;
+            typedef std::shared_ptr<const AnimatedSprite>   ConstPtr;
+
+                               ~AnimatedSprite();
+            static Ptr          create(Animator& animator);
+
+                                AnimatedSprite(const AnimatedSprite&) = delete;
+            AnimatedSprite&     operator=(const AnimatedSprite&) = delete;
+
+            //the clip must outlive the sprite, or be replaced before. negative
+            //speeds play backwards, clips that do not loop from their end..
+            void                play(AnimationClip::ConstPtr clip, float speed = 1.f);
+            void                stop();
+            void                setSpeed(float speed);
+            float               getSpeed() const;
+            size_t              getFrame() const;
+            bool                isFinished() const;
+
+        private:
+            friend class Animator;
+
+            explicit            AnimatedSprite(Animator& animator);
+
+            Animator*               m_animator;
+            size_t                  m_slot;
+            AnimationClip::ConstPtr m_clip;
+    };
+}
+
+#endif // ANIMATED_SPRITE_H
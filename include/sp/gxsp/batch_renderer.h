@@ -7,6 +7,7 @@
 #include <sp/gxsp/render_states.h>
 #include <sp/gxsp/drawable.h>
 #include <sp/gxsp/framebuffer.h>
+#include <sp/gxsp/frame_capture.h>
 #include <sp/math/vec.h>
 #include <sp/math/rect.h>
 #include <memory>
@@ -17,6 +18,7 @@ namespace sp
     class Controller;
     class Meta;
     class Batch;
+    struct ImmediateDraw;
     enum SP_Invalidation : char
     {
         SP_ALL           = 0x7f,
@@ -42,7 +44,7 @@ namespace sp
      *  - draw sprites for given z-order..
      */
 
-    //can i please not allocate memory for every drawable??
+    //drawables are tracked by handle, their states are pooled (see Drawable::Handle)..
     class SP_API Renderer
     {
         public:
@@ -59,19 +61,58 @@ namespace sp
             const Viewport& getViewport() const;
             const Viewport& getDefaultViewport() const;
 
+            //a part of the world, shown on a part of the surface (in pixels)..
+            struct View
+            {
+                Viewport    viewport;
+                recti       screen;
+            };
+
+            //split-screen and minimaps: the drawables are refreshed and sorted
+            //once, every view then culls and replays the batches with its own
+            //projection. drawables with a viewport of their own (e.g. the gui)
+            //are drawn once, on top of all views. without any view the default
+            //viewport covers the whole surface..
+            void            setViews(const std::vector<View>& views);
+            void            addView(const Viewport& viewport, const recti& screen);
+            void            clearViews();
+            size_t          getViewCount() const;
+
             void            setAlphaThreshold(float threshold);
+
+            //lets drawables of equal states join a batch across z-orders as long
+            //as they overlap nothing drawn in between; the result looks the same.
+            //off by default, since any moving drawable then rebuilds the batches..
+            void            setBatchReordering(bool enable);
+
+            //draws alpha and additive drawables alike with BlendPremultiplied, so
+            //they share batches; their vertex colours are premultiplied (additive
+            //ones with zero alpha). applies to untextured drawables and those with
+            //a premultiplied texture, see Texture::setPremultiplyOnLoad..
+            void            setPremultipliedAlpha(bool enable);
+
+            //draw calls of the retained drawables, as of the last draw()..
+            size_t          getBatchCount() const;
             void            setPostProcessShader(const sp::Shader* shader);
+            void            setFrameCapture(FrameCapture* capture);
             //void            addBatchDrawable();
             void            addDrawable(const Drawable::Ptr primitive, bool set_max);
-            void            addDrawable(      Drawable::DrawableStates::Ptr primitive, bool set_max);
+            void            addDrawable(      Drawable::Handle handle, bool set_max);
 
             void            removeDrawable(const Drawable::Ptr primitive);
-            void            removeDrawable(      Drawable::DrawableStates::Ptr ptr);
+            void            removeDrawable(      Drawable::Handle handle);
 
             void            resetStatesGL();
             void            invalidate(char = 0x7f);
             void            draw();
+
+            //queued for the current tick and drawn on top of the retained
+            //drawables, sorted and batched like them. the controller drops the
+            //queue after every render check, so draws issued per update are
+            //replaced rather than piled up. only pointers to the texture and
+            //shader are recorded; they must outlive the tick..
             void            draw(Drawable::Ptr drawable);
+            void            draw(const Drawable& drawable);
 
         private:
                             Renderer();
@@ -88,11 +129,30 @@ namespace sp
             void            applyTexture(const Texture* shader);
 
             void            removeDanglingDrawables();
+            const Shader*   getTransformShader();
             void            setupDraw();
             void            cleanupDraw();
 
+            //what a pass draws, the overlays being drawables with a viewport of their own..
+            enum Pass : char
+            {
+                PassWorld   = 1 << 0,
+                PassOverlay = 1 << 1,
+                PassAll     = PassWorld | PassOverlay
+            };
+
+            void            drawPass(Shader* transform_shader, char pass);
+            void            boundBatches();
+            void            loadView(const View& view);
+            bool            isOverlay(const Viewport* viewport) const;
+            void            flushImmediate(char pass);
+            //ends the tick of the immediate draws, called by the controller..
+            void            releaseImmediate();
+            void            pointArrays(size_t first_vertex, bool slots);
+
             void            swap(Drawable& p1, Drawable& p2);
             void            refresh();
+            void            reorderBatches(std::vector<Meta>& sorted);
 
             void            initialize();
             void            ensureResize();
@@ -126,13 +186,37 @@ namespace sp
             std::vector<vec2f>              m_positions;
             std::vector<Color>              m_colors;
             std::vector<vec2f>              m_tex_coords;
+            std::vector<Color>              m_user_data;
+
+            //transform slot of every vertex, and the drawable in every slot..
+            std::vector<float>              m_slots;
+            std::vector<Drawable::Handle>   m_transform_handles;
+            std::vector<gl::vec4f>          m_transforms;
             std::vector<vec2f>              m_particles;
 
             //mutable data..
             std::vector<unsigned int>       m_indices;
+
+            //0-1-2-2-1-3 for every quad, shared by all quad batches; only ever grown..
+            std::vector<unsigned int>       m_quad_indices;
             std::vector<Meta>               m_drawables;
 
             std::vector<Batch>  m_batches;
+
+            //the drawables of every batch, into m_drawables; kept for culling..
+            std::vector<size_t>             m_batch_members;
+
+            std::vector<View>               m_views;
+            const View*                     m_current_view;
+
+            //tick arena of the immediate draws, see releaseImmediate..
+            std::vector<vec2f>              m_immediate_positions;
+            std::vector<Color>              m_immediate_colors;
+            std::vector<vec2f>              m_immediate_tex_coords;
+            std::vector<Color>              m_immediate_user_data;
+            std::vector<unsigned int>       m_immediate_indices;
+            std::vector<unsigned int>       m_immediate_sorted;
+            std::vector<ImmediateDraw>      m_immediate_draws;
             size_t                          m_vertex_count;
             size_t                          m_index_count;
             vec2u                           m_size;
@@ -153,12 +237,20 @@ namespace sp
 
             vec2f                           m_frame_position;
             const sp::Shader*               m_post_process_shader;
+            FrameCapture*                   m_frame_capture;
 
             mutable Framebuffer             m_primary_framebuffer;
             mutable Framebuffer             m_secondary_framebuffer;
 
             mat                             m_view_matrix;
             mat                             m_inv_view_matrix;
+
+            std::unique_ptr<Shader>         m_transform_shader;
+            int                             m_transforms_uniform;
+            int                             m_textured_uniform;
+            bool                            m_transform_checked;
+            bool                            m_reorder_batches;
+            bool                            m_premultiplied;
     };
 }
 #endif // BATCH_RENDERER_H
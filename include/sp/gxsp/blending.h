@@ -44,6 +44,7 @@ namespace sp
 
     extern const Blending BlendAlpha;
     extern const Blending BlendAdd;
+    extern const Blending BlendPremultiplied;
     extern const Blending BlendMultiply;
     extern const Blending BlendNone;
 
@@ -0,0 +1,69 @@
+#ifndef COMPRESSED_IMAGE_H
+#define COMPRESSED_IMAGE_H
+#include <sp/sp.h>
+#include <sp/math/vec.h>
+#include <vector>
+
+namespace sp
+{
+    /**
+     *  block-compressed image with a full mip chain..
+     *
+     *  container layout (little endian):
+     *      header      'SPTC', version, format, width, height, level count
+     *      levels      level count * {offset, size} relative to the file start
+     *      payload     the blocks of every level, largest first
+     *
+     *  a container loaded from memory is a view, the data has to outlive it..
+     */
+    class SP_API CompressedImage
+    {
+        public:
+            enum SP_Format : SPuint32
+            {
+                DXT1 = 1,
+                DXT3 = 2,
+                DXT5 = 3,
+                BC7  = 4
+            };
+
+            struct Level
+            {
+                unsigned int    width;
+                unsigned int    height;
+                const SPuint8*  data;
+                size_t          size;
+            };
+
+                            CompressedImage();
+
+            bool            loadFromFile(const char* filename);
+            bool            loadFromMemory(const void* data, size_t size);
+
+            SP_Format       getFormat() const;
+            const vec2u&    getSize() const;
+            unsigned int    getLevelCount() const;
+            const Level&    getLevel(unsigned int level) const;
+
+            static bool     isCompressedImage(const void* data, size_t size);
+            static size_t   getBlockSize(SP_Format format);
+            static size_t   getLevelSize(SP_Format format, unsigned int width, unsigned int height);
+
+            //decodes blocks into rgba8, used when the driver cannot sample the format..
+            static bool     decompress(SP_Format format, const void* blocks, unsigned int width, unsigned int height, SPuint8* rgba);
+
+            //encodes rgba8 into blocks..
+            static bool     compress(SP_Format format, const SPuint8* rgba, unsigned int width, unsigned int height, SPuint8* blocks);
+
+            //builds a complete container from rgba8, optionally with a box-filtered mip chain..
+            static std::vector<SPuint8> createContainer(SP_Format format, const SPuint8* rgba, unsigned int width, unsigned int height, bool mipmaps = true);
+
+        private:
+            std::vector<SPuint8>    m_storage;
+            std::vector<Level>      m_levels;
+            SP_Format               m_format;
+            vec2u                   m_size;
+    };
+}
+
+#endif // COMPRESSED_IMAGE_H
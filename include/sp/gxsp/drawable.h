@@ -6,6 +6,7 @@
 #include <sp/gxsp/render_states.h>
 #include <sp/math/vec.h>
 #include <memory>
+#include <unordered_map>
 
 namespace sp
 {
@@ -16,15 +17,31 @@ namespace sp
             typedef std::shared_ptr<Drawable>         Ptr;
             typedef std::shared_ptr<const Drawable>   ConstPtr;
 
+            //slot of the drawable's states in the states pool, plus the version
+            //of the slot it was handed out for; stale once the drawable is gone..
+            struct Handle
+            {
+                SPuint32    index   = 0;
+                SPuint32    version = 0;
+            };
+
             virtual ~Drawable();
+                    Drawable(const Drawable& other);
+            Drawable& operator=(const Drawable& other);
             //void merge(const Drawable& other);
 
             Ptr get();
 
+            //welds vertices equal in every attribute; see MeshBuilder for bulk geometry..
             virtual void add(const sp::Vertex& vertex);
             virtual void setTexture(const sp::Texture& texture);
             virtual void setShader(const sp::Shader& shader);
 
+            //four normalized bytes handed to the shader as 'attribute vec4 sp_UserData;'..
+            //drawables sharing a shader but not their user data still draw in one batch..
+                    void setUserData(const Color& data);
+            const Color& getUserData() const;
+
             virtual void setPosition(float x, float y);
                     void setPosition(const vec2f& position);
             const vec2f& getPosition() const;
@@ -60,10 +77,13 @@ namespace sp
             virtual rectf getGlobalBounds() const;
 
                     long int   getUniqueID() const;
+                    Handle     getHandle() const;
         protected:
             friend class Renderer;
             friend class Meta;
             friend class BatchDrawable;
+            friend class MeshBuilder;
+            friend class TransformGraph;
 
             struct CustomDrawStates
             {
@@ -98,14 +118,14 @@ namespace sp
             virtual void removeDrawable(Renderer& renderer);
             struct DrawableStates
             {
-                typedef std::shared_ptr<DrawableStates>         Ptr;
-                typedef std::shared_ptr<const DrawableStates>   ConstPtr;
                 States                      states;
                 bool                        visible;
                 vec2f                       position;
                 int                         zorder;
                 bool                        update;
+                bool                        moved;
                 rectf                       bounds;
+                Color                       user_data;
 
                 //DISCLAIMER:
                 //this* can never be dangling, because sp is owned by this*..
@@ -123,7 +143,9 @@ namespace sp
                     position    {},
                     zorder      {0},
                     update      {true},
+                    moved       {false},
                     bounds      {},
+                    user_data   {0, 0, 0, 0},
                     client      {nullptr},
                     vertex_entry{0},
                     index_entry {0},
@@ -138,7 +160,9 @@ namespace sp
                     position    {other.position},
                     zorder      {other.zorder},
                     update      {other.update},
+                    moved       {other.moved},
                     bounds      {other.bounds},
+                    user_data   {other.user_data},
                     client      {other.client},
                     vertex_entry{other.vertex_entry},
                     index_entry {other.index_entry},
@@ -157,7 +181,9 @@ namespace sp
                         position     = other.position;
                         zorder       = other.zorder;
                         update       = other.update;
+                        moved        = other.moved;
                         bounds       = other.bounds;
+                        user_data    = other.user_data;
                         client       = other.client;
                         vertex_entry = other.vertex_entry;
                         index_entry  = other.index_entry;
@@ -169,13 +195,25 @@ namespace sp
                 }
             };
 
-            //shared states for updates..
-            std::shared_ptr<DrawableStates> m_drawable_states;
+            //records live in chunks that are never moved nor freed; a released
+            //record is recycled with its version bumped, so a stale handle
+            //resolves to nullptr..
+            class StatesPool;
+
+            //nullptr if the drawable is gone..
+            static DrawableStates* lookup(Handle handle);
+
+            //shared states for updates, copies of a drawable share one record..
+            DrawableStates*             m_drawable_states;
+            Handle                      m_handle;
 
             //non-copyable data..
             std::vector<Vertex>         m_vertices;
             std::vector<unsigned int>   m_indices;
 
+            //vertex hash to index, for welding..
+            std::unordered_map<SPuint64, unsigned int> m_weld_index;
+
     };
 }
 #endif // PRIMITIVE_H_INCLUDED
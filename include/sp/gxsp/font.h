@@ -4,16 +4,15 @@
 #include <sp/math/vec.h>
 #include <sp/math/rect.h>
 #include <sp/gxsp/texture.h>
+#include <sp/gxsp/glyph_atlas.h>
 #include <memory>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace sp
 {
-    struct SP_API SP_Char
-    {
-        unsigned short x0, y0, x1, y1;
-        float xoff, yoff, advance;
-    };
+    class Shader;
 
     struct SP_API SP_Character
     {
@@ -22,7 +21,11 @@ namespace sp
         vec2f           bearing;
         vec2i           size;
         rectf           bounds;
+
+        //only filled in by Font::getGlyph..
         rectf           tex_coords;
+        unsigned int    page;
+        int             glyph;
     };
 
     struct SP_API SP_Font_Map
@@ -32,11 +35,35 @@ namespace sp
         float       linegap;
         float       scale;
         float       linespacing;
-        vec2i       size;
-        sp::Texture texture;
-        private:
-            friend class    Font;
-            SP_Char         char_data[255];
+    };
+
+    /**
+     *  glyphs rasterized ahead of time for a few sizes, see tools/spembed.cpp..
+     *
+     *  a baked size covers the codepoints [first, first + count); glyph metrics
+     *  are in pixels, the bitmap is width x height alpha at offset into pixels.
+     */
+    struct SP_API SP_Baked_Glyph
+    {
+        float           advance;
+        short           lsb;
+        short           x0, y0, x1, y1;
+        unsigned int    offset;
+    };
+
+    struct SP_API SP_Baked_Size
+    {
+        unsigned int            char_size;
+        unsigned int            first;
+        unsigned int            count;
+        const SP_Baked_Glyph*   glyphs;
+    };
+
+    struct SP_API SP_Baked_Font
+    {
+        const SP_Baked_Size*    sizes;
+        unsigned int            count;
+        const SPuint8*          pixels;
     };
 
     class SP_API Font : public std::enable_shared_from_this<Font>
@@ -50,25 +77,66 @@ namespace sp
                    Ptr      get();
 
             bool                loadFromFile(const char* filename);
+            bool                loadFromMemory(const void* data, size_t size);
+
+            //trusts the font's table offsets, prefer the sized overload..
             bool                loadFromMemory(const void* data);
             const SP_Character& getCharInfo(unsigned int codepoint, unsigned int char_size);
             int                 getKerning(unsigned int first, unsigned int second);
-            const sp::Texture&  getTexture(unsigned int charSize) const;
             const SP_Font_Map&  getMap(unsigned int char_size);
 
+            //glyphs are rasterized into the atlas on first use. fails if the
+            //page is full of referenced glyphs; try the next page then..
+            bool                getGlyph(unsigned int codepoint, unsigned int char_size, unsigned int page, SP_Character& character);
+            void                acquireGlyph(int glyph);
+            void                releaseGlyph(int glyph);
+            const sp::Texture*  getPageTexture(unsigned int page) const;
+            unsigned int        getMaxPages() const;
+            SPuint64            getAtlasGeneration() const;
+
+            //signed distance field glyphs, rasterized once at base_size and
+            //scaled to every character size; drawn with getDistanceFieldShader().
+            //must be chosen before any label uses the font..
+            void                setDistanceField(bool enable, unsigned int base_size = 32);
+            bool                isDistanceField() const;
+            static const Shader* getDistanceFieldShader();
+
+            //metrics and bitmaps of the baked sizes are taken from the table
+            //instead of the font; it must outlive the font and match its data..
+            void                setBakedGlyphs(const SP_Baked_Font* baked);
+
         private:
 
             Font();
             SP_Font_Map&        createFontMap(unsigned int char_size);
             SP_Character        createCharacter(unsigned int codepoint, unsigned char_size);
+            const SP_Character* getLatinTable(unsigned int char_size);
+            int                 getGlyphIndex(unsigned int codepoint);
+            void                loadKerning();
+            const SP_Baked_Glyph* findBaked(unsigned int codepoint, unsigned int char_size) const;
 
         private:
             void*   m_font_info;
             void*   m_file_data;
             bool    m_owning;
 
-                    std::map<SPuint64, SP_Character>    m_char_map;
+            //metrics for codepoints below 256 are dense per size, others are hashed..
+                    std::unordered_map<unsigned int, std::vector<SP_Character>> m_latin;
+                    std::unordered_map<SPuint64, SP_Character>  m_char_map;
+                    const SP_Character*                 m_latin_table;
+                    unsigned int                        m_latin_size;
+
+            //glyph indices and 'kern' pairs, (first << 16 | second) sorted..
+                    std::vector<int>                    m_glyph_indices;
+                    std::unordered_map<unsigned int, int> m_glyph_index_map;
+                    std::vector<std::pair<SPuint32, short>> m_kerning;
+                    std::unordered_map<SPuint32, short> m_kerning_cache;
             mutable std::map<unsigned int, SP_Font_Map> m_maps;
+                    GlyphAtlas                          m_atlas;
+                    std::vector<SPuint8>                m_raster;
+                    bool                                m_distance_field;
+                    unsigned int                        m_field_size;
+                    const SP_Baked_Font*                m_baked;
     };
 }
 
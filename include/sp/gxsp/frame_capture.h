@@ -0,0 +1,85 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+#include <sp/sp.h>
+#include <string>
+#include <vector>
+#include <future>
+#include <memory>
+
+namespace sp
+{
+    class Framebuffer;
+
+    struct SP_API CapturedFrame
+    {
+        unsigned int            width  = 0;
+        unsigned int            height = 0;
+        SPuint64                frame  = 0;
+
+        //rgba8, bottom row first (as read from gl)..
+        std::vector<SPuint8>    pixels;
+    };
+
+    /**
+     *  asynchronous framebuffer readback..
+     *
+     *  pixels are read into a ring of pack pbos, each guarded by a fence.
+     *  a request is resolved once its fence has signaled, which is usually
+     *  a few frames later; the rendering thread never waits on the gpu unless
+     *  the ring is exhausted..
+     *
+     *  e.g.
+     *      FrameCapture capture(3);
+     *      renderer.setFrameCapture(&capture);
+     *      auto frame = capture.request();     //ready a few frames later..
+     *      capture.record("frame_%05llu.png"); //dump every frame on a writer thread..
+     */
+    class SP_API FrameCapture
+    {
+        public:
+                                        FrameCapture(unsigned int depth = 3);
+                                       ~FrameCapture();
+
+                                        FrameCapture(const FrameCapture&) = delete;
+            FrameCapture&               operator=(const FrameCapture&) = delete;
+
+            //captures the next framebuffer passed to update()..
+            std::future<CapturedFrame>  request();
+
+            //starts a readback of the given framebuffer right away..
+            std::future<CapturedFrame>  request(const Framebuffer& framebuffer);
+
+            //encodes every frame passed to update() as png on a background thread;
+            //pattern is printf-like and receives the frame number (%llu)..
+            bool                        record(const char* pattern);
+            void                        stop();
+            bool                        isRecording() const;
+
+            //called once per frame by the renderer, after the frame has been resolved..
+            void                        update(const Framebuffer& framebuffer);
+
+            //resolves finished readbacks; blocks on all pending ones if wait is set..
+            void                        poll(bool wait = false);
+            size_t                      pending() const;
+
+        private:
+            struct Slot;
+            class  Writer;
+
+            Slot*                       acquire();
+            void                        readback(const Framebuffer& framebuffer, Slot& slot);
+            void                        resolve(Slot& slot);
+            void                        deliver(Slot& slot, CapturedFrame&& frame);
+            void                        release();
+
+            std::vector<Slot>           m_slots;
+            size_t                      m_head;
+            size_t                      m_pending;
+            SPuint64                    m_frame;
+
+            std::vector<std::promise<CapturedFrame>> m_requests;
+            std::unique_ptr<Writer>     m_writer;
+    };
+}
+
+#endif // FRAME_CAPTURE_H
@@ -6,6 +6,7 @@
 #include <sp/gxsp/color.h>
 //#include <sp/gxsp/render_target.h>
 #include <sp/gxsp/sprite.h>
+#include <vector>
 
 namespace sp
 {
@@ -47,11 +48,28 @@ namespace sp
                                     Blending blending   = BlendAlpha,
                                     const sp::Texture* texture = nullptr,
                                     const sp::Shader* shader   = nullptr);
+
+            //batched offscreen drawing, for bakes of many quads; the gl states
+            //are set up once by begin() and restored by end()..
+            //
+            //quads are four vertices each, in strip order (top left, bottom left,
+            //top right, bottom right) with texture coordinates in pixels. quads
+            //sharing texture and blending go out in a single draw call..
+            void                begin();
+            void                submit(const Vertex* quads,
+                                       size_t quad_count,
+                                       const sp::Texture* texture,
+                                       const vec2f& offset = {0.f, 0.f},
+                                       Blending blending   = BlendAlpha);
+            void                end();
         private:
+            friend class FrameCapture;
+
             void                copyColor(unsigned int dstID, int x = 0, int y = 0, int w = 0, int h = 0);
 
             void                deleteBuffers();
             bool                isComplete();
+            void                flushBatch();
 
             unsigned int    m_fbo_obj;
             unsigned int    m_fbo_msaa_obj;
@@ -69,6 +87,13 @@ namespace sp
             //Texture         m_dummy_texture;
             //sp:::Color      m_clear_color;
             vec2u           m_size;
+
+            //pending quads of begin()/end()..
+            std::vector<Vertex>         m_batch_vertices;
+            std::vector<unsigned int>   m_batch_indices;
+            const sp::Texture*          m_batch_texture;
+            Blending                    m_batch_blending;
+            bool                        m_batching;
     };
 }
 
@@ -0,0 +1,100 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+#include <sp/sp.h>
+#include <sp/math/rect.h>
+#include <sp/gxsp/texture.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace sp
+{
+    /**
+     *  on-demand glyph cache, backed by a few alpha texture pages..
+     *
+     *  glyphs are packed into shelves (rows of equal height) as they are first
+     *  used. once a page is full, the least recently used glyph that is not
+     *  referenced any more (see acquire/release) gives up its slot.
+     *
+     *  a glyph lives on a single page; callers that need all of their glyphs on
+     *  one texture, e.g. a label, ask for a page and move on to the next one
+     *  when insert() fails..
+     */
+    class SP_API GlyphAtlas
+    {
+        public:
+            struct Glyph
+            {
+                SPuint64        key;
+                unsigned int    page;
+                recti           area;
+                SPuint64        last_use;
+                unsigned int    refs;
+            };
+
+                                GlyphAtlas(unsigned int page_size = 1024, unsigned int max_pages = 4);
+                               ~GlyphAtlas();
+
+                                GlyphAtlas(const GlyphAtlas&) = delete;
+            GlyphAtlas&         operator=(const GlyphAtlas&) = delete;
+
+            //returns the glyph id or -1..
+            int                 find(SPuint64 key, unsigned int page);
+            int                 insert(SPuint64 key, unsigned int page, unsigned int width, unsigned int height, const SPuint8* pixels);
+
+            //referenced glyphs are never evicted..
+            void                acquire(int id);
+            void                release(int id);
+
+            const Glyph&        getGlyph(int id) const;
+            rectf               getTexCoords(int id) const;
+            const Texture*      getTexture(unsigned int page) const;
+            unsigned int        getPageCount() const;
+            unsigned int        getMaxPages() const;
+            unsigned int        getPageSize() const;
+
+            //bumped whenever a glyph is evicted, ids handed out before stay valid
+            //as long as it does not change..
+            SPuint64            getGeneration() const;
+
+            void                clear();
+
+        private:
+            struct Shelf
+            {
+                unsigned int    top;
+                unsigned int    height;
+                unsigned int    cursor;
+            };
+
+            struct Page
+            {
+                std::unique_ptr<Texture>    texture;
+                std::vector<Shelf>          shelves;
+                unsigned int                bottom;
+            };
+
+            struct Slot
+            {
+                Glyph           glyph;
+                recti           rect;
+                bool            used;
+            };
+
+            bool                createPage();
+            bool                allocate(Page& page, unsigned int width, unsigned int height, recti& rect);
+            int                 reuse(unsigned int page, unsigned int width, unsigned int height);
+            int                 evict(unsigned int page, unsigned int width, unsigned int height);
+            void                upload(const Slot& slot, const SPuint8* pixels);
+
+            std::vector<Page>                       m_pages;
+            std::vector<Slot>                       m_slots;
+            std::unordered_map<SPuint64, int>       m_lookup;
+            unsigned int                            m_page_size;
+            unsigned int                            m_max_pages;
+            SPuint64                                m_clock;
+            SPuint64                                m_generation;
+    };
+}
+
+#endif // GLYPH_ATLAS_H
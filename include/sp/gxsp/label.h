@@ -25,6 +25,11 @@ namespace sp
             void                setColor(const Color& color);
             void                setFont(Font::Ptr font);
 
+            //distance field fonts only; thickness and radius are fractions of
+            //the field's range, the outline and glow are drawn in a grey shade..
+            void                setOutline(float thickness, SPuint8 shade = 0);
+            void                setGlow(float radius);
+
             sp::vec2f           getSize() const;
             const String&       getString() const;
             void                setPosition(float x, float y) override;
@@ -34,7 +39,11 @@ namespace sp
                                 Label();
             void                refresh();
             virtual void        addDrawable(Renderer& renderer, bool max);
-            void                createCharacter(unsigned int prev, unsigned int curr);
+            bool                createCharacter(unsigned int prev, unsigned int curr);
+            bool                layout(size_t first);
+            void                releaseGlyphs(size_t first = 0);
+            bool                loadRun();
+            void                storeRun() const;
             void                insertCharacter(const vec2f& offset, const SP_Character& character);
             void                insertWhitespace(const vec2f& offset, float advance);
 
@@ -45,12 +54,19 @@ namespace sp
             Color                   m_color;
             std::weak_ptr<Font>     m_font;
 
+            //per character: atlas glyph (or -1), vertex count and pen position
+            //after it, so that a changed suffix can be laid out again alone..
+            std::vector<int>        m_glyphs;
+            std::vector<size_t>     m_vertex_ends;
+            std::vector<float>      m_advances;
+
             float                   m_ascent;
             float                   m_advance;
             unsigned int            m_char_size;
             size_t                  m_character_count;
             size_t                  m_previous_count;
             size_t                  m_traverser;
+            unsigned int            m_page;
             bool                    m_refresh;
     };
 }
@@ -0,0 +1,63 @@
+#ifndef MESH_BUILDER_H
+#define MESH_BUILDER_H
+#include <sp/sp.h>
+#include <sp/gxsp/vertex.h>
+#include <vector>
+
+namespace sp
+{
+    class Drawable;
+
+    /**
+     *  appends geometry to a drawable in linear time..
+     *
+     *  with welding enabled, vertices equal in every attribute (position, color
+     *  and texture coordinates, compared bitwise) share one index. welding looks
+     *  vertices up in a hash index kept by the drawable, so it also merges with
+     *  vertices welded by earlier builders or Drawable::add.
+     *
+     *      MeshBuilder mesh(drawable);
+     *      mesh.reserve(4 * count, 6 * count);
+     *      for(...)
+     *          mesh.addQuad(tl, tr, bl, br);
+     */
+    class SP_API MeshBuilder
+    {
+        public:
+            explicit            MeshBuilder(Drawable& target, bool weld = false);
+
+            void                reserve(size_t vertices, size_t indices);
+            void                setWelding(bool weld);
+            bool                isWelding() const;
+
+            //vertex and index in one, as Drawable::add..
+            void                add(const Vertex& vertex);
+
+            //returns the index of the vertex, welded if enabled..
+            unsigned int        addVertex(const Vertex& vertex);
+
+            //raw appends, never welded; returns the index of the first vertex..
+            unsigned int        addVertices(const Vertex* vertices, size_t count);
+            void                addIndices(const unsigned int* indices, size_t count, unsigned int base = 0);
+
+            void                addTriangle(const Vertex& v1, const Vertex& v2, const Vertex& v3);
+
+            //corners in the order top left, top right, bottom left, bottom right..
+            void                addQuad(const Vertex& tl, const Vertex& tr, const Vertex& bl, const Vertex& br);
+            void                addQuads(const Vertex* vertices, size_t quad_count);
+
+            //a triangle strip, unrolled into indexed triangles..
+            void                addStrip(const Vertex* vertices, size_t count);
+
+            size_t              getVertexCount() const;
+            size_t              getIndexCount() const;
+
+        private:
+            unsigned int        append(const Vertex& vertex);
+
+            Drawable&           m_target;
+            bool                m_weld;
+    };
+}
+
+#endif // MESH_BUILDER_H
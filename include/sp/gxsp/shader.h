@@ -4,6 +4,9 @@
 #include <sp/gxsp/spglsl.h>
 #include <sp/string.h>
 #include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 namespace sp
 {
     class SP_API Shader
@@ -14,6 +17,13 @@ namespace sp
                 Vertex,
                 Fragment
             };
+
+            //generic attributes bound by name before linking..
+            enum SP_Attribute
+            {
+                UserData = 6,
+                Slot     = 7
+            };
                             Shader();
                            ~Shader();
 
@@ -28,6 +38,10 @@ namespace sp
             bool            loadFromMemory(const void* data, SP_Program pr);
             bool            loadFromMemory(const void* vdata, const void* fdata);
 
+            //sources that are not zero-terminated, e.g. archive views..
+            bool            loadFromMemory(const void* data, size_t length, SP_Program pr);
+            bool            loadFromMemory(const void* vdata, size_t vlength, const void* fdata, size_t flength);
+
             bool            attachShaderProgram(const void* data, SP_Program pr);
 
             void            setUniform(const char* name, float val);
@@ -64,23 +78,92 @@ namespace sp
             void            setUniformArray(const char* name, const gl::mat4* pointer, size_t length);
 
 
+            //uniform values are staged and uploaded when the program is bound.
+            //ids stay valid across reloads of the same shader..
+            int             uniform(const char* name);
+
+            void            setUniform(int id, float val);
+            void            setUniform(int id, const gl::vec2f& val);
+            void            setUniform(int id, const gl::vec3f& val);
+            void            setUniform(int id, const gl::vec4f& val);
+
+            void            setUniform(int id, int val);
+            void            setUniform(int id, const gl::vec2i& val);
+            void            setUniform(int id, const gl::vec3i& val);
+            void            setUniform(int id, const gl::vec4i& val);
+
+            void            setUniform(int id, const gl::mat3& val);
+            void            setUniform(int id, const gl::mat4& val);
+
+            void            setUniformArray(int id, const float* pointer, size_t length);
+            void            setUniformArray(int id, const gl::vec2f* pointer, size_t length);
+            void            setUniformArray(int id, const gl::vec3f* pointer, size_t length);
+            void            setUniformArray(int id, const gl::vec4f* pointer, size_t length);
+
+            void            setUniformArray(int id, const int* pointer, size_t length);
+            void            setUniformArray(int id, const gl::vec2i* pointer, size_t length);
+            void            setUniformArray(int id, const gl::vec3i* pointer, size_t length);
+            void            setUniformArray(int id, const gl::vec4i* pointer, size_t length);
+
+            void            setUniformArray(int id, const gl::mat3* pointer, size_t length);
+            void            setUniformArray(int id, const gl::mat4* pointer, size_t length);
+
+            //uploads staged values, when the program is bound already..
+            void            flushUniforms() const;
+
             unsigned int    getHandleGL() const;
             unsigned int    getCurrentTexture() const;
 
             static void     bind(const Shader*);
             static bool     shader_objects_supported();
+
+            //linked programs are cached as binaries, keyed by source and driver..
+            static void     setProgramCacheDirectory(const char* directory);
+
+            //shaders loaded between begin and end compile in parallel,
+            //link status is collected in endBatch()..
+            static void     beginBatch();
+            static bool     endBatch();
+            bool            isReady() const;
         private:
-            friend class Uniform;
-            bool            compile(const char* shader);
-            bool            compile(const char* vshader, const char* fshader);
+            enum class SP_UniformType : SPuint8
+            {
+                None,
+                Float1, Float2, Float3, Float4,
+                Int1,   Int2,   Int3,   Int4,
+                Mat3,   Mat4
+            };
+
+            struct UniformSlot
+            {
+                std::string     name;
+                int             location;
+                SP_UniformType  type;
+                SPuint32        count;
+                size_t          offset;
+                size_t          size;
+                size_t          capacity;
+                bool            dirty;
+            };
+
+            bool            compile(const char* shader, int length = -1);
+            bool            compile(const char* vshader, const char* fshader, int vlength = -1, int flength = -1);
+            bool            finishLink();
+            void            release();
             void            bindTextures() const;
             int             getUniformLocation(const char* name);
-
-            std::map<int, unsigned int>     m_texture_map;
-            std::map<String, unsigned int>  m_uniform_map;
-            unsigned int                    m_native_shader;
-            mutable  int                    m_current_texture;
-            SP_Program                      m_type;
+            void            stage(int id, SP_UniformType type, const void* data, size_t size, size_t count);
+
+            std::map<int, unsigned int>             m_texture_map;
+            std::unordered_map<std::string, int>    m_uniform_ids;
+            mutable std::vector<UniformSlot>        m_uniforms;
+            mutable std::vector<int>                m_dirty_uniforms;
+            std::vector<SPuint8>                    m_uniform_block;
+            unsigned int                            m_native_shader;
+            mutable  int                            m_current_texture;
+            SP_Program                              m_type;
+            SPuint64                                m_program_key;
+            bool                                    m_pending;
     };
 }
 #endif // SHADER_H
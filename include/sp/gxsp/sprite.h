@@ -39,13 +39,15 @@ namespace sp
             const Color&        getColor() const;
 
 
-        private:
-            friend class SpriteBatch;
-
+        protected:
                                 Sprite();
             explicit            Sprite(const Texture& texture);
                                 Sprite(const Texture& texture, const recti& area);
 
+            //normalized left, top, right, bottom; leaves the texture rect alone..
+            void                setTexCoords(const rectf& coords);
+
+        private:
             virtual void        addDrawable(Renderer& renderer, bool max) override;
             void                add(const sp::Vertex& vertex) override;
             void                updatePositions();
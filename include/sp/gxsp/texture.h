@@ -1,9 +1,11 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 #include <sp/math/rect.h>
+#include <sp/gxsp/color.h>
 
 namespace sp
 {
+    class CompressedImage;
     class SP_API Texture
     {
         public:
@@ -21,6 +23,8 @@ namespace sp
             bool create(unsigned int width, unsigned int height, int iformat = 0x1908, int format = 0x1908);
             bool loadFromFile(const char* filename, const recti& = recti{});
             bool loadFromMemory(const void* data, unsigned int width, unsigned int height, const recti& = recti{});
+            bool loadFromMemory(const void* data, size_t size, const recti& = recti{});
+            bool loadFromCompressed(const CompressedImage& image);
             void setRepeated(bool repeat);
             void setSmooth(bool smooth);
             void update(const SPuint8* pixels);
@@ -29,23 +33,39 @@ namespace sp
             void update(const Texture& texture, unsigned int x, unsigned int y);
             void setFlipped(bool flip);
             void clearArea(int x, int y, int width, int height);
+            void clear(const recti& area, const Color& color = Color{0, 0, 0, 0});
+            void fill(const Color& color);
+            void copy(const Texture& source, const recti& area, const vec2u& position);
             void createPBO();
 
             bool isSmooth() const;
             bool isRepeated() const;
             bool generateMipmap() const;
             bool isFlipped() const;
+            bool isCompressed() const;
+
+            //GL_ALPHA storage; shaders sample it as black, unlike GL_MODULATE..
+            bool isAlphaOnly() const;
             const vec2u& getSize() const;
             unsigned int getHandleGL() const;
             static void bind(const Texture* texture, SP_Mapping = Normalized);
             static unsigned int getMaxTexSize();
 
+            //images loaded from now on get their colour multiplied by their alpha
+            //before upload (see BlendPremultiplied); pre-compressed images and
+            //pixels passed to update() are uploaded as they are..
+            static void setPremultiplyOnLoad(bool premultiply);
+            static bool getPremultiplyOnLoad();
+            static void premultiply(SPuint8* pixels, size_t count);
+            bool isPremultiplied() const;
+
             void reset();
         private:
             friend class Target;
             friend class Framebuffer;
 
             void invalidateMipmap();
+            bool loadPixels(const void* data, unsigned int width, unsigned int height, const recti& area);
 
         private:
             vec2u           m_size;
@@ -56,6 +76,8 @@ namespace sp
             bool            m_is_copy;
             bool            m_is_fbo_attachment;
             mutable bool    m_mipmap_generated;
+            bool            m_compressed;
+            bool            m_premultiplied;
 
             int             m_iformat;
             int             m_format;
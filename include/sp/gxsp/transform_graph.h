@@ -0,0 +1,86 @@
+#ifndef TRANSFORM_GRAPH_H
+#define TRANSFORM_GRAPH_H
+#include <sp/sp.h>
+#include <sp/gxsp/drawable.h>
+#include <sp/gxsp/transformable.h>
+#include <vector>
+
+namespace sp
+{
+    /**
+     *  parent/child transforms for things that move together, e.g. a
+     *  weapon held by a character or a light on a torch..
+     *
+     *  nodes are kept in flat arrays, every parent ahead of its children,
+     *  so update() resolves the world matrices of all dirty subtrees in one
+     *  pass front to back. drawables attached to a node receive its world
+     *  translation, which is all the renderer applies to them; rotation and
+     *  scale only carry over to child nodes.
+     *
+     *  a node id is recycled once destroyed..
+     */
+    class SP_API TransformGraph
+    {
+        public:
+            typedef SPuint32    Node;
+            static constexpr Node None = 0xffffffff;
+
+                                TransformGraph();
+                               ~TransformGraph();
+
+            Node                create(Node parent = None);
+
+            //destroys the children as well..
+            void                destroy(Node node);
+            bool                setParent(Node node, Node parent);
+            Node                getParent(Node node) const;
+            bool                contains(Node node) const;
+            size_t              size() const;
+
+            void                setPosition(Node node, const vec2f& position);
+            void                setRotation(Node node, float angle);
+            void                setScale(Node node, const vec2f& scale);
+            void                setOrigin(Node node, const vec2f& origin);
+            void                move(Node node, const vec2f& offset);
+            const Transformable& getLocal(Node node) const;
+
+            //as of the last update..
+            const affine2&      getWorldTransform(Node node) const;
+            vec2f               getWorldPosition(Node node) const;
+
+            //the drawable is placed at offset in the node's space..
+            void                attach(Node node, Drawable& drawable, const vec2f& offset = {});
+            void                detach(const Drawable& drawable);
+
+            //recomputes dirty world matrices and moves their drawables..
+            void                update();
+
+        private:
+            struct Attachment
+            {
+                Drawable::Handle    handle;
+                Node                node;
+                vec2f               offset;
+            };
+
+            SPuint32            slotOf(Node node) const;
+            void                markDirty(Node node);
+            void                reorder();
+
+            //indexed by node id..
+            std::vector<SPuint32>       m_slots;
+            std::vector<Node>           m_free;
+
+            //indexed by slot, parents first..
+            std::vector<Node>           m_nodes;
+            std::vector<SPuint32>       m_parents;
+            std::vector<Transformable>  m_locals;
+            std::vector<affine2>        m_worlds;
+            std::vector<SPuint8>        m_dirty;
+
+            std::vector<Attachment>     m_attachments;
+            bool                        m_reorder;
+    };
+}
+
+#endif // TRANSFORM_GRAPH_H
@@ -1,6 +1,7 @@
 #ifndef TRANSFORMABLE_H
 #define TRANSFORMABLE_H
 #include <sp/math/mat.h>
+#include <sp/math/affine.h>
 #include <sp/math/vec.h>
 
 namespace sp
@@ -31,17 +32,21 @@ namespace sp
             void            scale(float x, float y);
             void            scale(const vec2f& scale);
 
-            const mat&      getMatrix() const;
-            const mat&      getInverseMatrix() const;
+            const affine2&  getTransform() const;
+            const affine2&  getInverseTransform() const;
+
+            //expanded from the affine transform on every call, meant for upload..
+            mat             getMatrix() const;
+            mat             getInverseMatrix() const;
 
         private:
             vec2f           m_origin;
             vec2f           m_position;
             float           m_rotation;
             vec2f           m_scale;
-            mutable mat     m_matrix;
+            mutable affine2 m_transform;
             mutable bool    m_update_mat;
-            mutable mat     m_inv_matrix;
+            mutable affine2 m_inv_transform;
             mutable bool    m_update_inv_mat;
     };
 }
@@ -0,0 +1,111 @@
+#ifndef SP_AFFINE_H
+#define SP_AFFINE_H
+#include <sp/sp.h>
+#include <sp/math/vec.h>
+#include <sp/math/rect.h>
+#include <sp/math/mat.h>
+#include <cstddef>
+
+namespace sp
+{
+    /**
+     *  2d affine transform in six floats..
+     *
+     *      x' = a * x + c * y + tx
+     *      y' = b * x + d * y + ty
+     *
+     *  composition and inversion are constexpr; convert to mat or the gl
+     *  4x4 layout only when handing it to gl.
+     */
+    struct affine2
+    {
+        float   a,  b;
+        float   c,  d;
+        float   tx, ty;
+
+        SP_CONSTEXPR affine2() :
+            a {1.f}, b {0.f},
+            c {0.f}, d {1.f},
+            tx{0.f}, ty{0.f}
+        {
+        }
+
+        SP_CONSTEXPR affine2(float _a, float _b, float _c, float _d, float _tx, float _ty) :
+            a {_a},  b {_b},
+            c {_c},  d {_d},
+            tx{_tx}, ty{_ty}
+        {
+        }
+
+        static SP_CONSTEXPR affine2 translation(float x, float y)
+        {
+            return affine2{1.f, 0.f, 0.f, 1.f, x, y};
+        }
+
+        static SP_CONSTEXPR affine2 scaling(float x, float y)
+        {
+            return affine2{x, 0.f, 0.f, y, 0.f, 0.f};
+        }
+
+        //clockwise in degrees, as Transformable..
+        static affine2 rotation(float angle);
+
+        SP_CONSTEXPR float determinant() const
+        {
+            return a * d - b * c;
+        }
+
+        //identity if the transform is singular..
+        SP_CONSTEXPR affine2 inverse() const
+        {
+            float det = determinant();
+            if(det == 0.f)
+                return affine2{};
+
+            float inv = 1.f / det;
+            return affine2
+            {
+                 d * inv, -b * inv,
+                -c * inv,  a * inv,
+                (c * ty - d * tx) * inv,
+                (b * tx - a * ty) * inv
+            };
+        }
+
+        SP_CONSTEXPR vec2f transformPoint(float x, float y) const
+        {
+            return vec2f{a * x + c * y + tx, b * x + d * y + ty};
+        }
+
+        SP_CONSTEXPR vec2f transformPoint(const vec2f& p) const
+        {
+            return transformPoint(p.x, p.y);
+        }
+
+        rectf   transformRect(const rectf& area) const;
+
+        //column major 4x4, ready for glLoadMatrixf..
+        void    toGL(float out[16]) const;
+        mat     toMat() const;
+    };
+
+    //this applied after other..
+    SP_CONSTEXPR affine2 operator*(const affine2& m, const affine2& other)
+    {
+        return affine2
+        {
+            m.a * other.a  + m.c * other.b,
+            m.b * other.a  + m.d * other.b,
+            m.a * other.c  + m.c * other.d,
+            m.b * other.c  + m.d * other.d,
+            m.a * other.tx + m.c * other.ty + m.tx,
+            m.b * other.tx + m.d * other.ty + m.ty
+        };
+    }
+
+    //batch versions, sse2 where available; source and destination may be the same..
+    SP_API void transformPoints(const affine2& m, const vec2f* points, vec2f* out, size_t count);
+    SP_API void transformRects(const affine2& m, const rectf* rects, rectf* out, size_t count);
+}
+
+#endif // SP_AFFINE_H
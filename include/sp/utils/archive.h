@@ -0,0 +1,92 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+#include <sp/sp.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace sp
+{
+    /**
+     *  read-only, memory-mapped asset archive..
+     *
+     *  layout (little endian):
+     *      header      'SPAK', version, entry count, blob alignment, toc offset, names offset
+     *      blobs       entry data, each aligned to the blob alignment
+     *      toc         entries sorted by name hash: {hash, offset, stored size, size, flags, name}
+     *      names       zero-terminated entry names, to resolve hash collisions
+     *
+     *  stored entries are handed out as views straight into the mapping, e.g.
+     *
+     *      Archive archive;
+     *      archive.open("assets.spak");
+     *      Archive::View font = archive.find("fonts/arial.ttf");
+     *      font_ptr->loadFromMemory(font.data, font.size);
+     *
+     *  compressed entries are decoded once on first access and cached for the lifetime
+     *  of the archive. views stay valid until the archive is closed.
+     *
+     *  no view is zero-terminated, stored or compressed alike; always pass the size on..
+     */
+    class SP_API Archive
+    {
+        public:
+            struct View
+            {
+                const void*     data = nullptr;
+                size_t          size = 0;
+
+                explicit operator bool() const { return data != nullptr; }
+            };
+
+            struct Source
+            {
+                std::string             name;
+                std::vector<SPuint8>    data;
+            };
+
+                            Archive();
+                           ~Archive();
+
+                            Archive(const Archive&) = delete;
+            Archive&        operator=(const Archive&) = delete;
+
+            bool            open(const char* path);
+            void            close();
+            bool            isOpen() const;
+
+            View            find(const char* name) const;
+            bool            contains(const char* name) const;
+            size_t          getEntryCount() const;
+
+            static SPuint64 hash(const char* name);
+
+            //writes an archive; entries are compressed when it pays off..
+            static bool     build(const char* path, std::vector<Source>& sources, bool compress = true);
+
+            //lz4 block format..
+            static size_t   compressBound(size_t size);
+            static size_t   compressBlock(const SPuint8* src, size_t size, SPuint8* dst, size_t capacity);
+            static bool     decompressBlock(const SPuint8* src, size_t size, SPuint8* dst, size_t raw_size);
+
+        private:
+            struct Entry;
+
+            const Entry*    lookup(const char* name) const;
+
+            const SPuint8*  m_data;
+            size_t          m_size;
+            const Entry*    m_entries;
+            SPuint32        m_count;
+            const char*     m_names;
+            size_t          m_names_size;
+
+            //platform mapping handles..
+            void*           m_file;
+            void*           m_mapping;
+
+            mutable std::unordered_map<const Entry*, std::vector<SPuint8>> m_decoded;
+    };
+}
+
+#endif // ARCHIVE_H
@@ -138,9 +138,22 @@ namespace sp
 
     void Levler::loadRuleSet(const char* path)
     {
-        sp::String output;
-        size_t file_length;
+        size_t file_length = 0;
         char* data = reinterpret_cast<char*>(spHelperFileData(path, &file_length));
+        if(!data)
+        {
+            SP_PRINT_WARNING("cannot open rule set " << path);
+            return;
+        }
+
+        loadRuleSet(data, file_length);
+        free(data);
+    }
+
+    void Levler::loadRuleSet(const void* source, size_t file_length)
+    {
+        sp::String output;
+        const char* data = reinterpret_cast<const char*>(source);
         for(size_t i = 0; i < file_length; i++)
         {
             if(isWhitespace(data[i]))
@@ -180,8 +193,6 @@ namespace sp
 
             pos = output.find_first_of("{}", pos + 1);
         }
-
-        free(data);
     }
 
     vec2u Levler::getMapSize() const
@@ -251,6 +262,7 @@ namespace sp
         framebuffer.create(width * m_sprite_unit_length, height * m_sprite_unit_length);
         framebuffer.bind();
         framebuffer.clear();
+        framebuffer.begin();
 
         unsigned int unit_length = m_tex_unit_length + m_padding + 1;
 
@@ -305,17 +317,11 @@ namespace sp
                 texture_quad[2].texCoords = vec2f{top_left.x + m_tex_unit_length, top_left.y};
                 texture_quad[3].texCoords = vec2f{top_left.x + m_tex_unit_length, top_left.y + m_tex_unit_length};
 
-                framebuffer.draw(texture_quad, 4, TriangleStrip,
-                                 vec2f{pos_x, pos_y},
-                                 vec2f{1.f, 1.f},
-                                 0.f,
-                                 BlendAlpha,
-                                 m_texture_atlas,
-                                 nullptr
-                                 );
+                framebuffer.submit(texture_quad, 1, m_texture_atlas, vec2f{pos_x, pos_y});
             }
              m_grid.push_back(tile);
         }
+        framebuffer.end();
         framebuffer.display();
         m_output_texture.create(width * m_sprite_unit_length, height * m_sprite_unit_length);
         m_output_texture.setFlipped(true);
@@ -379,7 +385,7 @@ namespace sp
         normalized.x = -1.f + 2.f * (x - m_bounds.left) / m_bounds.width;
         normalized.y =  1.f - 2.f * (y - m_bounds.top) / m_bounds.height;
         m_transformable.setPosition(m_bounds.left, m_bounds.top);
-        return m_transformable.getInverseMatrix().transformVertex(normalized);
+        return m_transformable.getInverseTransform().transformPoint(normalized);
     }
 
     vec2f Levler::mapPixels(const vec2f& pos)
@@ -390,7 +396,7 @@ namespace sp
     vec2i Levler::mapCoords(float x, float y)
     {
         m_transformable.setPosition(0.f, 0.f);
-        sp::vec2f normalized = m_transformable.getMatrix().transformVertex(x, y);
+        sp::vec2f normalized = m_transformable.getTransform().transformPoint(x, y);
 
         sp::vec2i pixel;
         pixel.x = static_cast<int>(std::floor(( normalized.x + 1.f) / 2.f * m_bounds.width + m_bounds.left + .5f));
@@ -112,9 +112,22 @@ namespace sp
 
     void Map2D::loadRuleSet(const char* path)
     {
-        size_t file_length;
-        std::u32string str;
+        size_t file_length = 0;
         char* data = reinterpret_cast<char*>(spHelperFileData(path, &file_length));
+        if(!data)
+        {
+            SP_PRINT_WARNING("cannot open rule set " << path);
+            return;
+        }
+
+        loadRuleSet(data, file_length);
+        free(data);
+    }
+
+    void Map2D::loadRuleSet(const void* source, size_t file_length)
+    {
+        std::u32string str;
+        const char* data = reinterpret_cast<const char*>(source);
         sp::String output(str);
 
         for(size_t i = 0; i < file_length; i++)
@@ -162,8 +175,6 @@ namespace sp
         }
 
         //printf("%s", output.toStdString().c_str());
-
-        free(data);
     }
 
     sp::Sprite::Ptr Map2D::getSprite() const
@@ -204,6 +215,7 @@ namespace sp
         printf("width: %d height: %d\n", width, height);
         framebuffer.create(width * m_unit_length, height * m_unit_length);
         framebuffer.bind();
+        framebuffer.begin();
         for(size_t i = 0; i < width * height; i++)
         {
             //float pos_x = (float)(static_cast<int>(i / width) * m_unit_length + m_padding);
@@ -234,16 +246,10 @@ namespace sp
             texture_quad[1].texCoords = vec2f{top_left.x,        top_left.y + 64.f};
             texture_quad[2].texCoords = vec2f{top_left.x + 64.f, top_left.y};
             texture_quad[3].texCoords = vec2f{top_left.x + 64.f, top_left.y + 64};
-            framebuffer.draw(texture_quad, 4, TriangleStrip,
-                             vec2f{pos_x, pos_y},
-                             vec2f{1.f, 1.f},
-                             0.f,
-                             BlendAlpha,
-                             m_texture_atlas,
-                             nullptr
-                             );
+            framebuffer.submit(texture_quad, 1, m_texture_atlas, vec2f{pos_x, pos_y});
         }
 
+        framebuffer.end();
         framebuffer.display();
 
         m_grid_texture.create(width * m_unit_length, height * m_unit_length);
@@ -1,11 +1,18 @@
 #include <sp/arb/overlay.h>
 #include <sp/gxsp/batch_renderer.h>
+#include <sp/gxsp/mesh_builder.h>
+#include <algorithm>
 
 namespace sp
 {
     SpriteBatch::SpriteBatch() :
         m_origin{0.f, 0.f}
     {
+        m_drawable_states->states.viewport = nullptr;
+        m_drawable_states->vertex_entry    = 0;
+        m_drawable_states->index_entry     = 0;
+        m_drawable_states->vertex_count    = 0;
+        m_drawable_states->index_count     = 0;
     }
 
     SpriteBatch::Ptr SpriteBatch::create()
@@ -13,156 +20,199 @@ namespace sp
         return Ptr(new SpriteBatch);
     }
 
-    void SpriteBatch::setPosition(int index, const sp::vec2f& pos)
+    void SpriteBatch::reserve(size_t count)
     {
-        if(index < 0 || index >= m_sprites.size())
-            return;
-
-        m_sprites[index].setPosition(pos);
-        /*
-        sp::vec2f origin = (m_vertices.begin() + index * 4)->position;
+        m_positions.reserve(count);
+        m_sizes.reserve(count);
+        m_tex_rects.reserve(count);
+        m_colors.reserve(count);
+        m_visible.reserve(count);
+        MeshBuilder(*this).reserve(count * 4, count * 6);
+    }
 
-        for(auto it = m_vertices.begin() + index * 4; it != m_vertices.begin() + index * 4 + 4; it++)
+    int SpriteBatch::addQuad(const Texture& texture, const vec2f& pos, const vec2f& size, const recti& area)
+    {
+        const Texture* current = m_drawable_states->states.texture;
+        if(current && current != &texture)
         {
-            sp::vec2f offset = it->position - origin;
-            it->position = pos + offset;
+            SP_PRINT_WARNING("all quads of a sprite batch must share one texture");
+            return -1;
         }
+        m_drawable_states->states.texture = &texture;
+
+        vec2u texture_size = texture.getSize();
+        vec2f sz = size;
+        recti ar = area;
+
+        if(sz == vec2f{})
+            sz = static_cast<vec2f>(texture_size);
+
+        if(area == recti{})
+            ar = recti{{0, 0}, texture_size};
+
+        int index = static_cast<int>(m_positions.size());
+        m_positions.push_back(pos - m_origin);
+        m_sizes.push_back(sz);
+        m_tex_rects.push_back(rectf
+        {
+            static_cast<float>(ar.left) / texture_size.x,
+            static_cast<float>(ar.top)  / texture_size.y,
+            static_cast<float>(ar.left + ar.width)  / texture_size.x,
+            static_cast<float>(ar.top  + ar.height) / texture_size.y
+        });
+        m_colors.push_back(Color{255, 255, 255, 255});
+        m_visible.push_back(1);
+
+        //vertex order as a sprite's: top left, bottom left, top right, bottom right..
+        Vertex corner;
+        MeshBuilder mesh(*this);
+        unsigned int first = mesh.addVertices(&corner, 1);
+        mesh.addVertices(&corner, 1);
+        mesh.addVertices(&corner, 1);
+        mesh.addVertices(&corner, 1);
+
+        const unsigned int quad[6] = {0, 1, 2, 2, 1, 3};
+        mesh.addIndices(quad, 6, first);
+
+        writePositions(index);
+        writeTexCoords(index);
+        writeColors(index);
+        publish();
+        return index;
+    }
+
+    void SpriteBatch::setPosition(int index, const sp::vec2f& pos)
+    {
+        if(!valid(index))
+            return;
+
+        m_positions[index] = pos - m_origin;
+        writePositions(index);
         m_drawable_states->update = true;
-        */
     }
+
     void SpriteBatch::setColor(int index, const sp::Color& color)
     {
-        if(index < 0 || index >= m_sprites.size())
+        if(!valid(index))
             return;
-        //m_sprites[index].setColor(color);
-        m_sprites[index].m_drawable_states->update = true;
-        for(auto it = m_vertices.begin() + index * 4; it != m_vertices.begin() + index * 4 + 4; it++)
-            it->color = color;
+
+        m_colors[index] = color;
+        writeColors(index);
         m_drawable_states->update = true;
     }
 
     void SpriteBatch::setVisible(int index, bool visible)
     {
-        if(index < 0 || index >= m_sprites.size())
+        if(!valid(index) || m_visible[index] == visible)
             return;
-        m_sprites[index].setVisible(visible);
-    }
 
-    size_t SpriteBatch::size() const
-    {
-        return m_sprites.size();
+        m_visible[index] = visible;
+        writePositions(index);
+        m_drawable_states->update = true;
     }
 
-    int SpriteBatch::addQuad(const Texture& texture, const vec2f& pos, const vec2f& size, const recti& area)
+    bool SpriteBatch::isVisible(int index) const
     {
-        int return_index = m_sprites.size();
-        m_sprites.push_back(Sprite(texture));
-        Sprite& sprite = m_sprites.back();
-        //sprite.setTextureSprite(texture);
-
-        sp::vec2f sz = size;
-        sp::recti ar = area;
-
-        if(sz == sp::vec2f{})
-            sz = texture.getSize();
-
-        if(area == sp::recti{})
-            ar = sp::recti{{0, 0}, texture.getSize()};
-
-        sprite.setSize(sz);
-        sprite.setTextureRect(ar);
-
-        rectf bounds = sprite.m_drawable_states->bounds;
-
-        sprite.m_drawable_states->vertex_entry    = m_vertices.size();
-        sprite.m_drawable_states->index_entry     = m_indices.size();
-        sprite.m_drawable_states->position        = pos;
-        sprite.m_drawable_states->update          = true;
-        //sprite.m_drawable_states->id              = ++generator;
-
-        sprite.m_drawable_states->client          = this;
-        sprite.m_drawable_states->states.viewport = nullptr;
-        sprite.m_drawable_states->states.texture  = &texture;
-
-        m_vertices.insert(m_vertices.end(), sprite.m_vertices.begin(), sprite.m_vertices.end());
-        m_indices.insert(m_indices.end(), sprite.m_indices.begin(), sprite.m_indices.end());
+        if(!valid(index))
+            return false;
 
-        return return_index;
+        return m_visible[index];
     }
 
-    void SpriteBatch::addDrawable(Renderer& renderer, bool max)
+    vec2f SpriteBatch::getPosition(int index) const
     {
-        for(Sprite& sprite: m_sprites)
-        {
-            renderer.addDrawable(sprite.m_drawable_states, max);
-        }
+        return valid(index) ? m_positions[index] + m_origin : vec2f{};
     }
 
-    void SpriteBatch::removeDrawable(Renderer& renderer)
+    vec2f SpriteBatch::getSize(int index) const
     {
-         for(Sprite& sprite : m_sprites)
-         {
-             renderer.removeDrawable(sprite.m_drawable_states);
-         }
+        return valid(index) ? m_sizes[index] : vec2f{};
     }
 
-    bool SpriteBatch::isVisible(int index) const
+    Color SpriteBatch::getColor(int index) const
     {
-        if(index < 0 || index >= m_sprites.size())
-            return false;
+        return valid(index) ? m_colors[index] : Color{};
+    }
 
-        return m_sprites[index].isVisible();
+    size_t SpriteBatch::size() const
+    {
+        return m_positions.size();
     }
 
     void SpriteBatch::removeSprite(int index)
     {
-        if(index < 0 || index >= m_sprites.size())
+        if(!valid(index))
             return;
 
-        m_sprites.erase(m_sprites.begin() + index);
-    }
-
+        m_positions.erase(m_positions.begin() + index);
+        m_sizes.erase(m_sizes.begin() + index);
+        m_tex_rects.erase(m_tex_rects.begin() + index);
+        m_colors.erase(m_colors.begin() + index);
+        m_visible.erase(m_visible.begin() + index);
 
+        //quads keep their index pattern, so only the tail of the indices goes..
+        m_vertices.erase(m_vertices.begin() + index * 4, m_vertices.begin() + index * 4 + 4);
+        m_indices.resize(m_positions.size() * 6);
+        publish();
+    }
 
     void SpriteBatch::uniformTranslate(const vec2f& pos)
     {
-        vec2f prev_origin = m_origin;
+        //quads are relative to the origin, so the whole batch moves as one..
         m_origin = pos;
-        for(auto& sprite : m_sprites)
-        {
-            vec2f offset = sprite.m_drawable_states->position - prev_origin;
-            sprite.setPosition(pos + offset);
-        }
+        Drawable::setPosition(pos.x, pos.y);
+    }
+
+    void SpriteBatch::uniformTranslate(float x, float y)
+    {
+        uniformTranslate(vec2f{x, y});
     }
 
     void SpriteBatch::uniformVisibility(bool visible)
     {
-        for(auto& sprite : m_sprites)
-        {
-            sprite.setVisible(visible);
-        }
+        std::fill(m_visible.begin(), m_visible.end(), static_cast<SPuint8>(visible));
+        for(size_t i = 0; i < m_positions.size(); ++i)
+            writePositions(i);
+        m_drawable_states->update = true;
     }
-    void SpriteBatch::uniformTranslate(float x, float y)
+
+    bool SpriteBatch::valid(int index) const
     {
-        uniformTranslate(vec2f{x, y});
+        return index >= 0 && static_cast<size_t>(index) < m_positions.size();
     }
 
+    void SpriteBatch::writePositions(size_t index)
+    {
+        //hidden quads collapse to a point, so the indices never change..
+        vec2f pos  = m_positions[index];
+        vec2f size = m_visible[index] ? m_sizes[index] : vec2f{0.f, 0.f};
+        Vertex* quad = &m_vertices[index * 4];
+        quad[0].position = vec2f{pos.x,          pos.y};
+        quad[1].position = vec2f{pos.x,          pos.y + size.y};
+        quad[2].position = vec2f{pos.x + size.x, pos.y};
+        quad[3].position = vec2f{pos.x + size.x, pos.y + size.y};
+    }
 
-    const Sprite& SpriteBatch::get(int index) const
+    void SpriteBatch::writeTexCoords(size_t index)
     {
-        if(index < 0 || index >= m_sprites.size())
-            return sp::Sprite{};
+        const rectf& area = m_tex_rects[index];
+        Vertex* quad = &m_vertices[index * 4];
+        quad[0].texCoords = vec2f{area.left,  area.top};
+        quad[1].texCoords = vec2f{area.left,  area.height};
+        quad[2].texCoords = vec2f{area.width, area.top};
+        quad[3].texCoords = vec2f{area.width, area.height};
+    }
 
-        return m_sprites[index];
+    void SpriteBatch::writeColors(size_t index)
+    {
+        Vertex* quad = &m_vertices[index * 4];
+        quad[0].color = quad[1].color = quad[2].color = quad[3].color = m_colors[index];
     }
 
-    Sprite& SpriteBatch::get(int index)
+    void SpriteBatch::publish()
     {
-        if(index < 0 || index >= m_sprites.size())
-        {
-            static sp::Sprite sprite;
-            return sprite;
-        }
-        return m_sprites[index];
+        m_drawable_states->vertex_count = m_vertices.size();
+        m_drawable_states->index_count  = m_indices.size();
+        m_drawable_states->update       = true;
     }
 }
@@ -0,0 +1,259 @@
+#include <sp/gxsp/animated_sprite.h>
+#include <algorithm>
+#include <cmath>
+
+namespace sp
+{
+    AnimationClip::AnimationClip(const Texture& texture, float frame_time, bool loop) :
+        m_texture   {texture},
+        m_frame_time{frame_time > 0.f ? frame_time : 1.f},
+        m_loop      {loop}
+    {
+    }
+
+    AnimationClip::Ptr AnimationClip::create(const Texture& texture, float frame_time, bool loop)
+    {
+        return Ptr(new AnimationClip(texture, frame_time, loop));
+    }
+
+    void AnimationClip::addFrame(const recti& area)
+    {
+        vec2f size = static_cast<vec2f>(m_texture.getSize());
+        if(size.x <= 0.f || size.y <= 0.f)
+        {
+            SP_PRINT_WARNING("animation frame added for an empty texture");
+            return;
+        }
+
+        m_rects.push_back(area);
+        m_tex_coords.push_back(rectf
+        {
+            area.left / size.x,
+            area.top  / size.y,
+            (area.left + area.width)  / size.x,
+            (area.top  + area.height) / size.y
+        });
+    }
+
+    void AnimationClip::addFrames(const recti& first, unsigned int count, unsigned int columns)
+    {
+        if(!columns)
+            columns = count;
+
+        m_rects.reserve(m_rects.size() + count);
+        m_tex_coords.reserve(m_tex_coords.size() + count);
+        for(unsigned int i = 0; i < count; ++i)
+        {
+            addFrame(recti{first.left + static_cast<int>(i % columns) * first.width,
+                           first.top  + static_cast<int>(i / columns) * first.height,
+                           first.width, first.height});
+        }
+    }
+
+    size_t AnimationClip::getFrameCount() const
+    {
+        return m_rects.size();
+    }
+
+    const recti& AnimationClip::getFrameRect(size_t frame) const
+    {
+        return m_rects[frame];
+    }
+
+    const rectf& AnimationClip::getTexCoords(size_t frame) const
+    {
+        return m_tex_coords[frame];
+    }
+
+    const Texture& AnimationClip::getTexture() const
+    {
+        return m_texture;
+    }
+
+    float AnimationClip::getFrameTime() const
+    {
+        return m_frame_time;
+    }
+
+    float AnimationClip::getDuration() const
+    {
+        return m_frame_time * m_rects.size();
+    }
+
+    bool AnimationClip::isLooping() const
+    {
+        return m_loop;
+    }
+
+    size_t AnimationClip::getFrameAt(float time) const
+    {
+        size_t count = m_rects.size();
+        if(!count || time <= 0.f)
+            return 0;
+
+        size_t frame = static_cast<size_t>(time / m_frame_time);
+        return m_loop ? frame % count : std::min(frame, count - 1);
+    }
+
+    Animator::Animator()
+    {
+    }
+
+    Animator::~Animator()
+    {
+        for(AnimatedSprite* sprite : m_sprites)
+            sprite->m_animator = nullptr;
+    }
+
+    size_t Animator::size() const
+    {
+        return m_sprites.size();
+    }
+
+    size_t Animator::attach(AnimatedSprite* sprite)
+    {
+        m_sprites.push_back(sprite);
+        m_clips.push_back(nullptr);
+        m_times.push_back(0.f);
+        m_speeds.push_back(1.f);
+        m_frames.push_back(0);
+        return m_sprites.size() - 1;
+    }
+
+    void Animator::detach(size_t slot)
+    {
+        //swap the last sprite into the hole, so the arrays stay dense..
+        size_t last = m_sprites.size() - 1;
+        if(slot != last)
+        {
+            m_sprites[slot] = m_sprites[last];
+            m_clips[slot]   = m_clips[last];
+            m_times[slot]   = m_times[last];
+            m_speeds[slot]  = m_speeds[last];
+            m_frames[slot]  = m_frames[last];
+            m_sprites[slot]->m_slot = slot;
+        }
+
+        m_sprites.pop_back();
+        m_clips.pop_back();
+        m_times.pop_back();
+        m_speeds.pop_back();
+        m_frames.pop_back();
+    }
+
+    void Animator::update(float delta_seconds)
+    {
+        size_t count = m_sprites.size();
+        m_changed.clear();
+
+        //advance every clock first, this loop touches nothing but floats..
+        float* times = m_times.data();
+        const float* speeds = m_speeds.data();
+        for(size_t i = 0; i < count; ++i)
+            times[i] += delta_seconds * speeds[i];
+
+        //then resolve frames, keeping only the sprites that have to change..
+        for(size_t i = 0; i < count; ++i)
+        {
+            const AnimationClip* clip = m_clips[i];
+            if(!clip || !clip->getFrameCount())
+                continue;
+
+            //wrapped here so looping clocks do not lose precision over time,
+            //either way round; the others stop at their ends..
+            float duration = clip->getDuration();
+            if(!clip->isLooping())
+            {
+                times[i] = std::min(std::max(times[i], 0.f), duration);
+            }
+            else if(duration > 0.f && (times[i] >= duration || times[i] < 0.f))
+            {
+                times[i] = std::fmod(times[i], duration);
+                if(times[i] < 0.f)
+                    times[i] += duration;
+            }
+
+            unsigned int frame = static_cast<unsigned int>(clip->getFrameAt(times[i]));
+            if(frame != m_frames[i])
+            {
+                m_frames[i] = frame;
+                m_changed.push_back(i);
+            }
+        }
+
+        for(size_t i : m_changed)
+            m_sprites[i]->setTexCoords(m_clips[i]->getTexCoords(m_frames[i]));
+    }
+
+    AnimatedSprite::AnimatedSprite(Animator& animator) :
+        Sprite(),
+        m_animator{&animator},
+        m_slot    {animator.attach(this)},
+        m_clip    {}
+    {
+    }
+
+    AnimatedSprite::~AnimatedSprite()
+    {
+        if(m_animator)
+            m_animator->detach(m_slot);
+    }
+
+    AnimatedSprite::Ptr AnimatedSprite::create(Animator& animator)
+    {
+        return Ptr(new AnimatedSprite(animator));
+    }
+
+    void AnimatedSprite::play(AnimationClip::ConstPtr clip, float speed)
+    {
+        if(!m_animator)
+        {
+            SP_PRINT_WARNING("animated sprite outlived its animator");
+            return;
+        }
+
+        m_clip = clip;
+        m_animator->m_clips[m_slot]  = m_clip.get();
+        m_animator->m_times[m_slot]  = (m_clip && speed < 0.f && !m_clip->isLooping()) ? m_clip->getDuration() : 0.f;
+        m_animator->m_speeds[m_slot] = speed;
+        m_animator->m_frames[m_slot] = 0;
+
+        //all frames share the size of the first one..
+        if(m_clip && m_clip->getFrameCount())
+        {
+            setTexture(m_clip->getTexture());
+            setTextureRect(m_clip->getFrameRect(0));
+        }
+    }
+
+    void AnimatedSprite::stop()
+    {
+        if(m_animator)
+            m_animator->m_speeds[m_slot] = 0.f;
+    }
+
+    void AnimatedSprite::setSpeed(float speed)
+    {
+        if(m_animator)
+            m_animator->m_speeds[m_slot] = speed;
+    }
+
+    float AnimatedSprite::getSpeed() const
+    {
+        return m_animator ? m_animator->m_speeds[m_slot] : 0.f;
+    }
+
+    size_t AnimatedSprite::getFrame() const
+    {
+        return m_animator ? m_animator->m_frames[m_slot] : 0;
+    }
+
+    bool AnimatedSprite::isFinished() const
+    {
+        if(!m_animator || !m_clip || m_clip->isLooping())
+            return false;
+        if(m_animator->m_speeds[m_slot] < 0.f)
+            return m_animator->m_times[m_slot] <= 0.f;
+        return m_animator->m_times[m_slot] >= m_clip->getDuration();
+    }
+}
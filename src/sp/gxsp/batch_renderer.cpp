@@ -28,6 +28,126 @@ namespace sp
             return GL_ZERO;
         }
 
+        //drawables per batch whose translation is applied by the transform shader..
+        const unsigned int transform_slots = 64;
+
+        const char* transform_vertex_shader = R"(
+            #version 110
+            uniform vec4    sp_Transforms[64];
+            attribute float sp_Slot;
+
+            void main()
+            {
+                vec4 transform = sp_Transforms[int(sp_Slot + 0.5)];
+                gl_Position    = gl_ModelViewProjectionMatrix * vec4(gl_Vertex.xy + transform.xy, gl_Vertex.zw);
+                gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;
+                gl_FrontColor  = gl_Color;
+            }
+        )";
+
+        const char* transform_fragment_shader = R"(
+            #version 110
+            uniform sampler2D texture;
+            uniform float     sp_Textured;
+
+            //0: untextured, 1: textured, 2: alpha-only, modulated like GL_MODULATE..
+            void main()
+            {
+                vec4 texel   = sp_Textured > 0.5 ? texture2D(texture, gl_TexCoord[0].xy) : vec4(1.0);
+                if(sp_Textured > 1.5)
+                    texel    = vec4(1.0, 1.0, 1.0, texel.a);
+                gl_FragColor = texel * gl_Color;
+            }
+        )";
+
+        const unsigned int quad_pattern[6] = {0, 1, 2, 2, 1, 3};
+
+        //how many groups a drawable may be moved back over when reordering..
+        const size_t reorder_window = 128;
+
+        //area of a vertex range, padded so lines and points still have one..
+        rectf vertexBounds(const vec2f* positions, size_t count, float pad)
+        {
+            if(!count)
+                return rectf{};
+
+            vec2f low  = positions[0];
+            vec2f high = low;
+            for(size_t i = 1; i < count; ++i)
+            {
+                low.x  = std::min(low.x,  positions[i].x);
+                low.y  = std::min(low.y,  positions[i].y);
+                high.x = std::max(high.x, positions[i].x);
+                high.y = std::max(high.y, positions[i].y);
+            }
+            pad = std::max(1.f, pad);
+            return rectf{low.x - pad, low.y - pad, high.x - low.x + 2.f * pad, high.y - low.y + 2.f * pad};
+        }
+
+        rectf unite(const rectf& a, const rectf& b)
+        {
+            float left   = std::min(a.left, b.left);
+            float top    = std::min(a.top,  b.top);
+            float right  = std::max(a.left + a.width,  b.left + b.width);
+            float bottom = std::max(a.top  + a.height, b.top  + b.height);
+            return rectf{left, top, right - left, bottom - top};
+        }
+
+        //true if the drawable's indices are nothing but consecutive quads..
+        bool isQuadRange(const unsigned int* index, size_t vertex_count, size_t index_count)
+        {
+            size_t quads = vertex_count / 4;
+            if(!quads || vertex_count % 4 || index_count != quads * 6)
+                return false;
+
+            for(size_t q = 0; q < quads; ++q)
+            {
+                unsigned int base = static_cast<unsigned int>(q * 4);
+                for(unsigned int k : quad_pattern)
+                {
+                    if(*index++ != base + k)
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        enum BlendClass : char
+        {
+            BlendAsIs,
+            BlendPremultipliedAlpha,
+            BlendPremultipliedAdd
+        };
+
+        //custom shaders write colours of their own, those keep their blending..
+        char blendClass(const States& states, bool premultiplied)
+        {
+            if(!premultiplied || states.shader)
+                return BlendAsIs;
+            if(states.texture && !states.texture->isPremultiplied())
+                return BlendAsIs;
+
+            if(states.blend_mode == BlendAlpha)
+                return BlendPremultipliedAlpha;
+            if(states.blend_mode == BlendAdd)
+                return BlendPremultipliedAdd;
+            return BlendAsIs;
+        }
+
+        Color premultipliedColor(const Color& color, char blend_class)
+        {
+            if(blend_class == BlendAsIs)
+                return color;
+
+            auto scale = [&](SPuint8 c)->SPuint8
+            {
+                unsigned int product = c * color.a + 128u;
+                return static_cast<SPuint8>((product + (product >> 8)) >> 8);
+            };
+            return Color{scale(color.r), scale(color.g), scale(color.b),
+                         blend_class == BlendPremultipliedAdd ? SPuint8(0) : color.a};
+        }
+
         SPuint32 translateBlendEquation(Blending::SP_Equation eq)
         {
             switch(eq)
@@ -41,7 +161,6 @@ namespace sp
         }
     }
 
-    ///SHARED_PTR<DrawableStates>!!!!!
     struct Meta
     {
         long int                id;
@@ -66,9 +185,21 @@ namespace sp
 
         States                  states;
 
-        //compare reference to update drawable states..
-        std::weak_ptr<Drawable::DrawableStates>   drawable;
+        //resolves to nullptr once the drawable is gone..
+        Drawable::Handle                handle;
+
+        //translated by the transform shader, vertices are kept untranslated..
+        bool                            gpu_transform;
         bool                            toggle;
+
+        //see blendClass, the vertex colours are converted accordingly..
+        char                            blend_class;
+
+        //of the vertices in m_positions, untranslated like them..
+        rectf                           bounds;
+
+        //index into m_drawables, for the copies being sorted..
+        size_t                          source;
     };
 
     struct Batch
@@ -76,6 +207,38 @@ namespace sp
         unsigned int    index_start;
         unsigned int    index_count;
         States          states;
+
+        //slots of the transform shader, into m_transform_handles..
+        size_t          transform_first = 0;
+        size_t          transform_count = 0;
+
+        //quad batches draw a contiguous vertex range with the shared quad indices..
+        bool            quads           = false;
+        size_t          vertex_start    = 0;
+        size_t          quad_count      = 0;
+
+        //drawables of the batch, into m_batch_members..
+        size_t          member_first    = 0;
+        size_t          member_count    = 0;
+
+        //world area of the drawables as of this frame, for culling views..
+        rectf           bounds;
+        bool            bounded         = false;
+    };
+
+    //a queued draw of the tick arena, only the states that split a batch..
+    struct ImmediateDraw
+    {
+        const Texture*  texture;
+        const Shader*   shader;
+        const Viewport* viewport;
+        int             primitive_type;
+        float           point_size;
+        Blending        blend_mode;
+        bool            lighting;
+        int             zorder;
+        size_t          index_start;
+        size_t          index_count;
     };
 
     Renderer::Renderer() :
@@ -88,7 +251,14 @@ namespace sp
         m_particle_count{0},
         m_index_resize  {true},
         m_index_refresh_count{1},
-        m_post_process_shader{nullptr}
+        m_post_process_shader{nullptr},
+        m_frame_capture{nullptr},
+        m_transforms_uniform{-1},
+        m_textured_uniform{-1},
+        m_transform_checked{false},
+        m_reorder_batches{false},
+        m_premultiplied{false},
+        m_current_view{nullptr}
     {
         //createID();
     }
@@ -103,7 +273,14 @@ namespace sp
         m_particle_count{0},
         m_index_resize  {true},
         m_index_refresh_count{1},
-        m_post_process_shader{nullptr}
+        m_post_process_shader{nullptr},
+        m_frame_capture{nullptr},
+        m_transforms_uniform{-1},
+        m_textured_uniform{-1},
+        m_transform_checked{false},
+        m_reorder_batches{false},
+        m_premultiplied{false},
+        m_current_view{nullptr}
     {
     }
 
@@ -112,6 +289,7 @@ namespace sp
         m_drawables.clear();
         m_positions.clear();
         m_colors.clear();
+        m_user_data.clear();
         m_tex_coords.clear();
         m_batches.clear();
     }
@@ -126,6 +304,11 @@ namespace sp
         m_post_process_shader = shader;
     }
 
+    void Renderer::setFrameCapture(FrameCapture* capture)
+    {
+        m_frame_capture = capture;
+    }
+
     unsigned int Renderer::getFramebufferTexHandleGL() const
     {
         return m_primary_framebuffer.getTexHandleGL();
@@ -161,10 +344,47 @@ namespace sp
         m_cache.viewport_change = true;
     }
 
+    void Renderer::setViews(const std::vector<View>& views)
+    {
+        m_views = views;
+    }
+
+    void Renderer::addView(const Viewport& viewport, const recti& screen)
+    {
+        m_views.push_back(View{viewport, screen});
+    }
+
+    void Renderer::clearViews()
+    {
+        m_views.clear();
+    }
+
+    size_t Renderer::getViewCount() const
+    {
+        return m_views.size();
+    }
+
+    bool Renderer::isOverlay(const Viewport* viewport) const
+    {
+        return viewport && !viewport->defaulted() && *viewport != m_default_view;
+    }
+
+    void Renderer::loadView(const View& view)
+    {
+        //the projection of the view, squeezed into its part of the surface..
+        view.viewport.load();
+        int bottom = static_cast<int>(m_size.y) - (view.screen.top + view.screen.height);
+        spCheck(glViewport(view.screen.left, bottom, view.screen.width, view.screen.height))
+        spCheck(glScissor(view.screen.left, bottom, view.screen.width, view.screen.height))
+    }
+
     void Renderer::applyCurrentView()
     {
         //printf("apply current view..\n");
-        m_default_view.load();
+        if(m_current_view)
+            loadView(*m_current_view);
+        else
+            m_default_view.load();
         m_cache.viewport_change = false;
     }
 
@@ -229,8 +449,9 @@ namespace sp
         primitive->addDrawable(*this, set_max);
         //addDrawable(primitive->m_drawable_states, set_max);
     }
-    void Renderer::addDrawable(Drawable::DrawableStates::Ptr draw_states, bool set_max)
+    void Renderer::addDrawable(Drawable::Handle handle, bool set_max)
     {
+        Drawable::DrawableStates* draw_states = Drawable::lookup(handle);
         if(!draw_states)
         {
             return;
@@ -271,7 +492,9 @@ namespace sp
         if(draw_states->states.custom_draw_fn)
         {
             Meta meta;
-            meta.drawable                   = draw_states;
+            meta.handle                     = handle;
+            meta.gpu_transform              = false;
+            meta.blend_class                = BlendAsIs;
             meta.id                         = draw_states->id;
             meta.states.viewport            = draw_states->states.viewport;
             meta.states.custom_draw_fn      = draw_states->states.custom_draw_fn;
@@ -293,7 +516,9 @@ namespace sp
 
 
         Meta meta;
-        meta.drawable       = draw_states;
+        meta.handle         = handle;
+        meta.gpu_transform  = false;
+        meta.blend_class    = BlendAsIs;
         meta.id             = draw_states->id;
         meta.first_index    = first_vertex_count;
         meta.zorder         = draw_states->zorder;
@@ -320,6 +545,7 @@ namespace sp
 
         m_positions.reserve(m_vertex_count);
         m_colors.reserve(m_vertex_count);
+        m_user_data.reserve(m_vertex_count);
         m_tex_coords.reserve(m_vertex_count);
         m_indices.reserve(m_index_count);
 
@@ -331,8 +557,10 @@ namespace sp
             const sp::Vertex& vertex = primitive->m_vertices[i + draw_states->vertex_entry];
             m_positions.push_back(vertex.position);
             m_colors.push_back(vertex.color);
+            m_user_data.push_back(draw_states->user_data);
             m_tex_coords.push_back(vertex.texCoords);
         }
+        m_drawables.back().bounds = vertexBounds(m_positions.data() + meta.vertex_entry, meta.vertex_count, meta.states.point_size);
         m_index_refresh_count = 1;
         ///std::sort(m_drawables.begin(), m_drawables.end(), sort_lmbd);
     }
@@ -340,8 +568,9 @@ namespace sp
     //write to depth buffer with glDrawPixels(w, h, GL_DEPTH_COMPONENT, GL_FLOAT, buffer)??
     //stencil test by depth value (z = y position)??
 
-    void Renderer::removeDrawable(      Drawable::DrawableStates::Ptr ptr)
+    void Renderer::removeDrawable(      Drawable::Handle handle)
     {
+        Drawable::DrawableStates* ptr = Drawable::lookup(handle);
         if(!ptr)
             return;
 
@@ -358,7 +587,7 @@ namespace sp
         static std::vector<int> to_remove;
         for(auto& meta : m_drawables)
         {
-            if(!meta.drawable.lock() || meta.drawable.expired())
+            if(!Drawable::lookup(meta.handle))
             {
                 to_remove.push_back(meta.id);
             }
@@ -393,6 +622,7 @@ namespace sp
         if(meta->states.custom_draw_fn)
         {
             m_drawables.erase(it);
+            m_index_refresh_count = 1;
             return;
         }
         size_t start = meta->vertex_entry;
@@ -400,6 +630,7 @@ namespace sp
 
         m_positions.erase(m_positions.begin() + start, m_positions.begin() + end);
         m_colors.erase(m_colors.begin() + start, m_colors.begin() + end);
+        m_user_data.erase(m_user_data.begin() + start, m_user_data.begin() + end);
         m_tex_coords.erase(m_tex_coords.begin() + start, m_tex_coords.begin() + end);
 
         size_t v_entry = meta->vertex_entry;
@@ -441,29 +672,53 @@ namespace sp
         std::rotate(begin + size2, begin + size2 + size1, end);
     }
 
+    const Shader* Renderer::getTransformShader()
+    {
+        if(!m_transform_checked)
+        {
+            m_transform_checked = true;
+            if(Shader::shader_objects_supported())
+            {
+                m_transform_shader.reset(new Shader);
+                if(m_transform_shader->loadFromMemory(transform_vertex_shader, transform_fragment_shader))
+                {
+                    m_transforms_uniform = m_transform_shader->uniform("sp_Transforms");
+                    m_textured_uniform   = m_transform_shader->uniform("sp_Textured");
+                }
+                else
+                {
+                    SP_PRINT_WARNING("transform shader unavailable, drawables are translated on the cpu");
+                    m_transform_shader.reset();
+                }
+            }
+        }
+        return m_transform_shader.get();
+    }
+
     void Renderer::refresh()
     {
         //removeDanglingDrawables();
+        const bool transform_shader = getTransformShader() != nullptr;
 
         for(auto& meta : m_drawables)
         {
-            if(!meta.drawable.lock() || meta.drawable.expired())
+            Drawable::DrawableStates* ptr = Drawable::lookup(meta.handle);
+            if(!ptr)
                 continue;
 
-            if(meta.zorder != meta.drawable.lock()->zorder)
+            if(meta.zorder != ptr->zorder)
             {
-                meta.zorder = meta.drawable.lock()->zorder;
+                meta.zorder = ptr->zorder;
                 m_max_zorder = std::max(m_max_zorder, meta.zorder);
                 m_index_refresh_count = 1;
             }
 
             if(meta.states.custom_draw_fn)
             {
-                meta.states.custom_draw_enable = meta.drawable.lock()->states.custom_draw_enable;
+                meta.states.custom_draw_enable = ptr->states.custom_draw_enable;
                 continue;
             }
 
-            auto ptr = meta.drawable.lock();
             if(meta.toggle != ptr->visible)
             {
                 m_index_refresh_count = 1;
@@ -474,6 +729,26 @@ namespace sp
             {
                 m_index_refresh_count = 1;
             }
+
+            char blend_class = blendClass(ptr->states, m_premultiplied);
+            const Blending& blend_mode = blend_class == BlendAsIs ? ptr->states.blend_mode : BlendPremultiplied;
+            if(meta.blend_class != blend_class)
+            {
+                meta.blend_class = blend_class;
+                ptr->update = true;
+                m_index_refresh_count = 1;
+            }
+            if(meta.states.blend_mode != blend_mode)
+            {
+                meta.states.blend_mode = blend_mode;
+                m_index_refresh_count = 1;
+            }
+
+            //reordered batches only hold for the bounds they were built with..
+            if(m_reorder_batches && (ptr->moved || ptr->update))
+            {
+                m_index_refresh_count = 1;
+            }
         }
 
         static std::vector<Meta> sorter;
@@ -483,6 +758,8 @@ namespace sp
             sorter.clear();
             m_indices.clear();
             m_batches.clear();
+            m_batch_members.clear();
+            m_transform_handles.clear();
             index_count = 0;
         }
 
@@ -491,9 +768,11 @@ namespace sp
         bool resize = false;
         for(auto& meta : m_drawables)
         {
-            if(!meta.drawable.lock() || meta.drawable.expired())
+            Drawable::DrawableStates* ptr = Drawable::lookup(meta.handle);
+            if(!ptr)
                 continue;
 
+            meta.source = static_cast<size_t>(&meta - m_drawables.data());
             if(meta.states.custom_draw_fn)
             {
                 if(m_index_refresh_count > 0)
@@ -504,8 +783,19 @@ namespace sp
             }
 
 
-            auto ptr = meta.drawable.lock();
-            meta.states.texture = meta.drawable.lock()->states.texture;
+            meta.states.texture = ptr->states.texture;
+
+            //drawables with a shader of their own keep having their position baked in..
+            bool gpu_transform = transform_shader && !meta.states.shader;
+            if(meta.gpu_transform != gpu_transform)
+            {
+                meta.gpu_transform = gpu_transform;
+                ptr->update = true;
+            }
+            if(ptr->moved && !gpu_transform)
+                ptr->update = true;
+            ptr->moved = false;
+
             meta.vertex_entry = (previous) ? (previous->vertex_entry + previous->vertex_count) : 0;
             //meta.index_entry  = (previous) ? (previous->index_entry  + previous->index_count) : 0;
             meta.first_index  = (previous) ? (previous->first_index  + previous->vertex_count) : 0;
@@ -529,6 +819,7 @@ namespace sp
                 {
                     m_positions.resize(m_vertex_count);
                     m_colors.resize(m_vertex_count);
+                    m_user_data.resize(m_vertex_count);
                     m_tex_coords.resize(m_vertex_count);
 
 
@@ -539,6 +830,7 @@ namespace sp
                         {
                             m_positions.push_back(vertices[i + ptr->vertex_entry].position + ptr->position);
                             m_colors.push_back(vertices[i + ptr->vertex_entry].color);
+                            m_user_data.push_back(ptr->user_data);
                             m_tex_coords.push_back(vertices[i + ptr->vertex_entry].texCoords);
                         }
                     }
@@ -546,11 +838,13 @@ namespace sp
                     {
                         m_positions.erase(m_positions.begin() + meta.vertex_entry, m_positions.begin() + meta.vertex_entry + new_count);
                         m_colors.erase(m_colors.begin() + meta.vertex_entry, m_colors.begin() + meta.vertex_entry + new_count);
+                        m_user_data.erase(m_user_data.begin() + meta.vertex_entry, m_user_data.begin() + meta.vertex_entry + new_count);
                         m_tex_coords.erase(m_tex_coords.begin() + meta.vertex_entry, m_tex_coords.begin() + meta.vertex_entry + new_count);
                         for(size_t i = 0; i < meta.vertex_count; i++)
                         {
                             m_positions.insert(m_positions.begin() + meta.vertex_entry + i, vertices[i + ptr->vertex_entry].position + ptr->position);
                             m_colors.insert(m_colors.begin() + meta.vertex_entry + i, vertices[i + ptr->vertex_entry].color);
+                            m_user_data.insert(m_user_data.begin() + meta.vertex_entry + i, ptr->user_data);
                             m_tex_coords.insert(m_tex_coords.begin() + meta.vertex_entry + i, vertices[i + ptr->vertex_entry].texCoords);
                         }
                     }
@@ -559,6 +853,7 @@ namespace sp
                 {
                     m_positions.erase(m_positions.begin() + meta.vertex_entry + new_count, m_positions.begin() + meta.vertex_entry + old_count);
                     m_colors.erase(m_colors.begin() + meta.vertex_entry + new_count, m_colors.begin() + meta.vertex_entry + old_count);
+                    m_user_data.erase(m_user_data.begin() + meta.vertex_entry + new_count, m_user_data.begin() + meta.vertex_entry + old_count);
                     m_tex_coords.erase(m_tex_coords.begin() + meta.vertex_entry + new_count, m_tex_coords.begin() + meta.vertex_entry + old_count);
                 }
 
@@ -581,13 +876,16 @@ namespace sp
                     continue;
                 }
                 size_t entry = ptr->vertex_entry;
+                vec2f translation = meta.gpu_transform ? vec2f{0.f, 0.f} : ptr->position;
                 for(size_t i = 0; i < length; i++)
                 {
                     Vertex& vertex = vertices[i + entry];
-                    m_positions  [i + vertex_entry] = vertex.position + ptr->position;
-                    m_colors     [i + vertex_entry] = vertex.color;
+                    m_positions  [i + vertex_entry] = vertex.position + translation;
+                    m_colors     [i + vertex_entry] = premultipliedColor(vertex.color, meta.blend_class);
+                    m_user_data  [i + vertex_entry] = ptr->user_data;
                     m_tex_coords [i + vertex_entry] = vertex.texCoords;
                 }
+                meta.bounds = vertexBounds(m_positions.data() + vertex_entry, length, meta.states.point_size);
                 ptr->update = false;
             }
 
@@ -633,6 +931,8 @@ namespace sp
                 return (left_z < right_z);
             };
             std::sort(sorter.begin(), sorter.end(), lmbd);
+            if(m_reorder_batches)
+                reorderBatches(sorter);
 
             Batch batch;
             batch.states.texture       = nullptr;
@@ -683,6 +983,22 @@ namespace sp
             unsigned int offset         = 0;
             bool last_draw              = true;
 
+            //slots are written once per rebuild, moving a drawable only changes its transform..
+            m_slots.resize(m_positions.size());
+            size_t transform_first      = 0;
+            size_t transform_count      = 0;
+
+            bool quads                  = false;
+            size_t quad_vertex_start    = 0;
+            size_t quad_count           = 0;
+            size_t member_first         = 0;
+
+            //only viewports of their own split a batch, see isOverlay..
+            auto own_viewport = [this](const Viewport* v)->const Viewport*
+            {
+                return isOverlay(v) ? v : nullptr;
+            };
+
             //printf("sorter size: %lld\n", sorter.size());
             for(auto it = sorter.begin(); it != sorter.end(); ++it)
             {
@@ -692,7 +1008,8 @@ namespace sp
 
                 if(states.custom_draw_fn)
                 {
-                    if(meta.drawable.lock()->states.custom_draw_fn && states.custom_draw_enable)
+                    Drawable::DrawableStates* ptr = Drawable::lookup(meta.handle);
+                    if(ptr && ptr->states.custom_draw_fn && states.custom_draw_enable)
                     {
                         Batch tmp;
                         tmp.states.viewport             = states.viewport;
@@ -709,14 +1026,20 @@ namespace sp
                 {
                     continue;
                 }
+                Drawable::DrawableStates* ptr = Drawable::lookup(meta.handle);
+                bool meta_quads = ptr && states.primitive_type == Triangles && isQuadRange(ptr->client->m_indices.data() + ptr->index_entry, ptr->vertex_count, ptr->index_count);
+
                 unsigned meta_tex = meta.states.texture ? meta.states.texture->getHandleGL() : 0;
                 unsigned meta_shader = meta.states.shader ? meta.states.shader->getHandleGL() : 0;
                 if(     tex_obj                      != meta_tex
                    ||   shader_obj                   != meta_shader
                    ||   states.primitive_type   != primitive_type
                    ||   states.lighting         != lighting
-                   //||   states.viewport         != viewport
+                   ||   own_viewport(states.viewport) != own_viewport(viewport)
                    ||   states.blend_mode       != blending
+                   ||   (meta.gpu_transform && transform_count == transform_slots)
+                   ||   meta_quads != quads
+                   ||   (meta_quads && meta.vertex_entry != quad_vertex_start + quad_count * 4)
                    )
                 {
 
@@ -731,6 +1054,19 @@ namespace sp
 
                     batch.index_start           = offset;
                     batch.index_count           = index_count;
+                    batch.transform_first       = transform_first;
+                    batch.transform_count       = transform_count;
+                    batch.quads                 = quads;
+                    batch.vertex_start          = quad_vertex_start;
+                    batch.quad_count            = quad_count;
+                    batch.member_first          = member_first;
+                    batch.member_count          = m_batch_members.size() - member_first;
+                    member_first                = m_batch_members.size();
+                    transform_first             = m_transform_handles.size();
+                    transform_count             = 0;
+                    quads                       = meta_quads;
+                    quad_vertex_start           = meta.vertex_entry;
+                    quad_count                  = 0;
 
                     texture                     = meta.states.texture;
                     shader                      = meta.states.shader;
@@ -746,18 +1082,35 @@ namespace sp
                     offset                     += index_count;
                     index_count                 = 0;
 
-                    m_batches.push_back(batch);
+                    if(batch.index_count || batch.quad_count)
+                        m_batches.push_back(batch);
+                }
+
+                if(meta.gpu_transform)
+                {
+                    float slot = static_cast<float>(transform_count++);
+                    std::fill(m_slots.begin() + meta.vertex_entry, m_slots.begin() + meta.vertex_entry + meta.vertex_count, slot);
+                    m_transform_handles.push_back(meta.handle);
+                }
+                m_batch_members.push_back(meta.source);
+
+                //nothing to copy, the shared quad indices cover the range..
+                if(meta_quads)
+                {
+                    quad_count += meta.vertex_count / 4;
+                    last_draw = false;
+                    continue;
                 }
 
                 meta.index_entry = m_indices.size();
-                size_t entry = meta.drawable.lock()->index_entry;
+                size_t entry = ptr ? ptr->index_entry : 0;
                 for(size_t i = entry; i < (entry + meta.index_count); i++)
                 {
                     unsigned index = 0;
-                    if(meta.drawable.lock())
+                    if(ptr)
                     {
                         //DANGER!!
-                        index = meta.drawable.lock()->client->m_indices[i] + meta.first_index;
+                        index = ptr->client->m_indices[i] + meta.first_index;
                     }
                     else
                     {
@@ -773,6 +1126,13 @@ namespace sp
             //printf("batch draw..\n");
             batch.index_start           = offset;
             batch.index_count           = index_count;
+            batch.transform_first       = transform_first;
+            batch.transform_count       = transform_count;
+            batch.quads                 = quads;
+            batch.vertex_start          = quad_vertex_start;
+            batch.quad_count            = quad_count;
+            batch.member_first          = member_first;
+            batch.member_count          = m_batch_members.size() - member_first;
             batch.states.texture        = texture;
             batch.states.shader         = shader;
             batch.states.primitive_type = primitive_type;
@@ -780,7 +1140,13 @@ namespace sp
             batch.states.blend_mode     = blending;
             batch.states.lighting       = lighting;
             batch.states.viewport       = viewport;
-            m_batches.push_back(batch);
+            if(batch.index_count || batch.quad_count)
+                m_batches.push_back(batch);
+
+            //the shared quad indices have to reach the last vertex..
+            size_t quad_indices = (m_positions.size() / 4 + 1) * 6;
+            for(size_t i = m_quad_indices.size(); i < quad_indices; ++i)
+                m_quad_indices.push_back(static_cast<unsigned int>(i / 6 * 4) + quad_pattern[i % 6]);
         }
     }
 
@@ -806,6 +1172,153 @@ namespace sp
         m_cache.last_shader = shader;
     }
 
+    void Renderer::setBatchReordering(bool enable)
+    {
+        if(m_reorder_batches != enable)
+        {
+            m_reorder_batches = enable;
+            m_index_refresh_count = 1;
+        }
+    }
+
+    void Renderer::setPremultipliedAlpha(bool enable)
+    {
+        m_premultiplied = enable;
+    }
+
+    size_t Renderer::getBatchCount() const
+    {
+        return m_batches.size();
+    }
+
+    void Renderer::reorderBatches(std::vector<Meta>& sorted)
+    {
+        struct Group
+        {
+            const Meta*         head;
+            std::vector<size_t> members;
+            rectf               bounds;
+            bool                barrier;
+        };
+
+        //bounds of different viewports do not compare, see isOverlay..
+        auto own_viewport = [this](const Meta& meta)->const Viewport*
+        {
+            return isOverlay(meta.states.viewport) ? meta.states.viewport : nullptr;
+        };
+
+        auto same_states = [&own_viewport](const Meta& L, const Meta& R)->bool
+        {
+            unsigned int lt = L.states.texture ? L.states.texture->getHandleGL() : 0;
+            unsigned int rt = R.states.texture ? R.states.texture->getHandleGL() : 0;
+            unsigned int ls = L.states.shader  ? L.states.shader->getHandleGL()  : 0;
+            unsigned int rs = R.states.shader  ? R.states.shader->getHandleGL()  : 0;
+            return lt == rt && ls == rs
+                && L.states.primitive_type == R.states.primitive_type
+                && L.states.lighting       == R.states.lighting
+                && !(L.states.blend_mode   != R.states.blend_mode)
+                && own_viewport(L)         == own_viewport(R);
+        };
+
+        std::vector<Group>  groups;
+        std::vector<size_t> hidden;
+        groups.reserve(sorted.size());
+
+        for(size_t i = 0; i < sorted.size(); ++i)
+        {
+            const Meta& meta = sorted[i];
+
+            //callbacks may draw anywhere, nothing moves across them..
+            if(meta.states.custom_draw_fn)
+            {
+                groups.push_back(Group{&meta, {i}, rectf{}, true});
+                continue;
+            }
+
+            if(!meta.toggle || !meta.vertex_count)
+            {
+                hidden.push_back(i);
+                continue;
+            }
+
+            //screen bounds of the vertices the renderer holds..
+            rectf bounds = meta.bounds;
+            if(meta.gpu_transform)
+            {
+                Drawable::DrawableStates* ptr = Drawable::lookup(meta.handle);
+                if(ptr)
+                {
+                    bounds.left += ptr->position.x;
+                    bounds.top  += ptr->position.y;
+                }
+            }
+
+            //nearest earlier group of the same states, unless something in
+            //between overlaps..
+            Group* target = nullptr;
+            size_t end = groups.size() > reorder_window ? groups.size() - reorder_window : 0;
+            for(size_t g = groups.size(); g > end; --g)
+            {
+                Group& group = groups[g - 1];
+                if(group.barrier || own_viewport(*group.head) != own_viewport(meta))
+                    break;
+                if(same_states(*group.head, meta))
+                {
+                    target = &group;
+                    break;
+                }
+                if(group.bounds.intersects(bounds))
+                    break;
+            }
+
+            if(target)
+            {
+                target->members.push_back(i);
+                target->bounds = unite(target->bounds, bounds);
+            }
+            else
+            {
+                groups.push_back(Group{&meta, {i}, bounds, false});
+            }
+        }
+
+        std::vector<Meta> reordered;
+        reordered.reserve(sorted.size());
+        for(const Group& group : groups)
+        {
+            for(size_t i : group.members)
+                reordered.push_back(sorted[i]);
+        }
+        for(size_t i : hidden)
+            reordered.push_back(sorted[i]);
+
+        sorted.swap(reordered);
+    }
+
+    void Renderer::boundBatches()
+    {
+        for(auto& batch : m_batches)
+        {
+            batch.bounded = false;
+            for(size_t i = batch.member_first; i < batch.member_first + batch.member_count; ++i)
+            {
+                const Meta& meta = m_drawables[m_batch_members[i]];
+                rectf bounds = meta.bounds;
+                if(meta.gpu_transform)
+                {
+                    Drawable::DrawableStates* ptr = Drawable::lookup(meta.handle);
+                    if(ptr)
+                    {
+                        bounds.left += ptr->position.x;
+                        bounds.top  += ptr->position.y;
+                    }
+                }
+                batch.bounds  = batch.bounded ? unite(batch.bounds, bounds) : bounds;
+                batch.bounded = true;
+            }
+        }
+    }
+
     void Renderer::setAlphaThreshold(float threshold)
     {
         if(threshold > 0.f)
@@ -904,68 +1417,201 @@ namespace sp
 
     void Renderer::draw(Drawable::Ptr drawable)
     {
-        if(!drawable)
+        if(drawable)
+            draw(*drawable);
+    }
+
+    void Renderer::draw(const Drawable& drawable)
+    {
+        if(drawable.m_vertices.empty() || drawable.m_indices.empty())
             return;
 
-        if(drawable->m_vertices.empty() || drawable->m_indices.empty())
+        const Drawable::DrawableStates& draw_states = *drawable.m_drawable_states;
+        if(!draw_states.visible)
             return;
 
-		setupDraw();
-		spCheck(glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT | GL_CLIENT_VERTEX_ARRAY_BIT))
-        spCheck(glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT))
+        const States& states = draw_states.states;
+        ImmediateDraw record;
+        record.texture          = states.texture;
+        record.shader           = states.shader;
+        record.viewport         = states.viewport;
+        record.primitive_type   = states.primitive_type;
+        record.point_size       = states.point_size;
+        char blend_class        = blendClass(states, m_premultiplied);
+        record.blend_mode       = blend_class == BlendAsIs ? states.blend_mode : BlendPremultiplied;
+        record.lighting         = states.lighting;
+        record.zorder           = draw_states.zorder;
+        record.index_start      = m_immediate_indices.size();
+        record.index_count      = drawable.m_indices.size();
+
+        //translated here, the arena is drawn with an identity modelview..
+        unsigned int base = static_cast<unsigned int>(m_immediate_positions.size());
+        const vec2f& position = draw_states.position;
+        for(const Vertex& vertex : drawable.m_vertices)
+        {
+            m_immediate_positions.push_back(vertex.position + position);
+            m_immediate_colors.push_back(premultipliedColor(vertex.color, blend_class));
+            m_immediate_tex_coords.push_back(vertex.texCoords);
+            m_immediate_user_data.push_back(draw_states.user_data);
+        }
+
+        for(unsigned int index : drawable.m_indices)
+            m_immediate_indices.push_back(index + base);
 
-        const States& states = drawable->m_drawable_states->states;
+        m_immediate_draws.push_back(record);
+    }
 
-		if(states.primitive_type == GL_POINTS)
-		{
-			spCheck(glEnable(GL_LINE_SMOOTH));
-			spCheck(glEnable(GL_POINT_SMOOTH));
-			spCheck(glEnable(GL_POLYGON_SMOOTH));
-			spCheck(glPointSize(states.point_size))
+    void Renderer::pointArrays(size_t first_vertex, bool slots)
+    {
+        spCheck(glVertexPointer(2, GL_FLOAT, 0, m_positions.data() + first_vertex));
+        spCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_colors.data() + first_vertex));
+        spCheck(glTexCoordPointer(2, GL_FLOAT, 0, m_tex_coords.data() + first_vertex));
+
+        if(Shader::shader_objects_supported())
+            spCheck(glVertexAttribPointerARB(Shader::UserData, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, m_user_data.data() + first_vertex))
+        if(slots)
+            spCheck(glVertexAttribPointerARB(Shader::Slot, 1, GL_FLOAT, GL_FALSE, 0, m_slots.data() + first_vertex))
+    }
+
+    void Renderer::flushImmediate(char pass)
+    {
+        if(m_immediate_draws.empty())
+            return;
 
-			if(GL_ARB_point_sprite_supported)
-			{
-				spCheck(glEnable(GL_POINT_SPRITE_ARB))
-				spCheck(glTexEnvi(GL_POINT_SPRITE_ARB, GL_COORD_REPLACE_ARB, GL_TRUE))
-			}
-		}
+        //same order as the retained drawables: z-order, then texture..
+        std::stable_sort(m_immediate_draws.begin(), m_immediate_draws.end(),
+        [](const ImmediateDraw& L, const ImmediateDraw& R)->bool
+        {
+            if(L.zorder != R.zorder)
+                return L.zorder < R.zorder;
 
-		applyBlending(states.blend_mode);
-        applyTexture(states.texture);
-        applyShader(states.shader);
+            unsigned int lh = L.texture ? L.texture->getHandleGL() : 0;
+            unsigned int rh = R.texture ? R.texture->getHandleGL() : 0;
+            return lh < rh;
+        });
 
-        static Transformable trm;
+        const Blending  last_blend_mode = m_cache.last_blend_mode;
+        const Texture*  last_texture    = m_cache.last_texture;
+        const Shader*   last_shader     = m_cache.last_shader;
 
-        trm.setPosition(drawable->m_drawable_states->position);
         spCheck(glMatrixMode(GL_MODELVIEW))
-        spCheck(glLoadMatrixf(trm.getMatrix()()))
+        spCheck(glLoadIdentity())
+        spCheck(glVertexPointer(2, GL_FLOAT, 0, m_immediate_positions.data()))
+        spCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, m_immediate_colors.data()))
+        spCheck(glTexCoordPointer(2, GL_FLOAT, 0, m_immediate_tex_coords.data()))
 
-        const char* data = reinterpret_cast<const char*>(drawable->getVertices());
+        const bool user_data = Shader::shader_objects_supported();
+        if(user_data)
+        {
+            spCheck(glEnableVertexAttribArrayARB(Shader::UserData))
+            spCheck(glVertexAttribPointerARB(Shader::UserData, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, m_immediate_user_data.data()))
+        }
 
+        m_immediate_sorted.clear();
+        m_immediate_sorted.reserve(m_immediate_indices.size());
 
+        size_t first = 0;
+        while(first < m_immediate_draws.size())
+        {
+            const ImmediateDraw& head = m_immediate_draws[first];
 
-        spCheck(glVertexPointer(2, GL_FLOAT, sizeof(Vertex), data));
-        spCheck(glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), data + 8))
-        spCheck(glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), data + 12))
+            //gather every following draw that shares the head's states..
+            size_t run_start = m_immediate_sorted.size();
+            size_t last = first;
+            for(; last < m_immediate_draws.size(); ++last)
+            {
+                const ImmediateDraw& next = m_immediate_draws[last];
+                if(     next.texture        != head.texture
+                   ||   next.shader         != head.shader
+                   ||   next.viewport       != head.viewport
+                   ||   next.primitive_type != head.primitive_type
+                   ||   next.point_size     != head.point_size
+                   ||   next.lighting       != head.lighting
+                   ||   next.blend_mode     != head.blend_mode)
+                    break;
 
-        //DANGER!!
-        spCheck(glDrawElements(states.primitive_type, (size_t)drawable->m_indices.size(), GL_UNSIGNED_INT, (void*)(&drawable->m_indices[0]))) //OFFSET!!
-		if(states.primitive_type == GL_POINTS)
-		{
-			spCheck(glDisable(GL_POINT_SPRITE_ARB))
-			spCheck(glPointSize(1.f))
-			spCheck(glDisable(GL_LINE_SMOOTH));
-			spCheck(glDisable(GL_POINT_SMOOTH));
-			spCheck(glDisable(GL_POLYGON_SMOOTH));
-			if(GL_ARB_point_sprite_supported)
-			{
-				spCheck(glTexEnvi(GL_POINT_SPRITE_ARB, GL_COORD_REPLACE_ARB, GL_FALSE));
-			}
-		}
-		cleanupDraw();
-
-		spCheck(glPopClientAttrib())
-		spCheck(glPopAttrib())
+                m_immediate_sorted.insert(m_immediate_sorted.end(),
+                                          m_immediate_indices.begin() + next.index_start,
+                                          m_immediate_indices.begin() + next.index_start + next.index_count);
+            }
+
+            if(!(pass & (isOverlay(head.viewport) ? PassOverlay : PassWorld)))
+            {
+                first = last;
+                continue;
+            }
+
+            applyTexture(head.texture);
+            applyShader(head.shader);
+            if(head.blend_mode != m_cache.last_blend_mode)
+                applyBlending(head.blend_mode);
+
+            if(isOverlay(head.viewport))
+            {
+                head.viewport->load();
+                m_cache.viewport_change = true;
+            }
+            else if(m_cache.viewport_change)
+            {
+                applyCurrentView();
+            }
+
+            if(head.lighting)
+            {
+                spCheck(glEnable(GL_LIGHTING))
+            }
+
+            if(head.primitive_type == GL_POINTS)
+            {
+                spCheck(glEnable(GL_POINT_SMOOTH));
+                spCheck(glPointSize(head.point_size))
+                if(GL_ARB_point_sprite_supported)
+                {
+                    spCheck(glEnable(GL_POINT_SPRITE_ARB))
+                    spCheck(glTexEnvi(GL_POINT_SPRITE_ARB, GL_COORD_REPLACE_ARB, GL_TRUE))
+                }
+            }
+
+            spCheck(glDrawElements(head.primitive_type, static_cast<GLsizei>(m_immediate_sorted.size() - run_start),
+                                   GL_UNSIGNED_INT, m_immediate_sorted.data() + run_start))
+
+            if(head.primitive_type == GL_POINTS)
+            {
+                spCheck(glPointSize(1.f))
+                spCheck(glDisable(GL_POINT_SMOOTH));
+                if(GL_ARB_point_sprite_supported)
+                {
+                    spCheck(glTexEnvi(GL_POINT_SPRITE_ARB, GL_COORD_REPLACE_ARB, GL_FALSE));
+                    spCheck(glDisable(GL_POINT_SPRITE_ARB))
+                }
+            }
+
+            if(head.lighting)
+            {
+                spCheck(glDisable(GL_LIGHTING))
+            }
+
+            first = last;
+        }
+
+        if(user_data)
+            spCheck(glDisableVertexAttribArrayARB(Shader::UserData))
+
+        //the retained pass keeps its own notion of the bound states..
+        applyTexture(last_texture);
+        applyShader(last_shader);
+        applyBlending(last_blend_mode);
+    }
+
+    void Renderer::releaseImmediate()
+    {
+        //the arena keeps its capacity for the next frame..
+        m_immediate_positions.clear();
+        m_immediate_colors.clear();
+        m_immediate_tex_coords.clear();
+        m_immediate_user_data.clear();
+        m_immediate_indices.clear();
+        m_immediate_draws.clear();
     }
 
     void Renderer::drawFrame(float x, float y, float width, float height, const sp::Texture* texture, const sp::Shader* shader, Viewport* viewport)
@@ -1031,41 +1677,26 @@ namespace sp
     }
 
 
-    /*
-     *  1. draw scene to fbo..
-     *  2. draw color attachment to screen..
-     *  3. draw radial gradient to fbo..
-     *  4. draw color attachment to screen..
-     */
-    void Renderer::draw()
+    void Renderer::drawPass(Shader* transform_shader, char pass)
     {
-        //printf("ok 1..\n");
-        refresh();
-
-        if((!m_index_count || m_indices.empty()) && m_batches.empty())
-        {
-            return;
-        }
-        //printf("pos: %lld, colors: %lld, tcs: %lld\n", m_positions.size(), m_colors.size(), m_tex_coords.size());
-        setupDraw();
-        spCheck(glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT | GL_CLIENT_VERTEX_ARRAY_BIT))
-        spCheck(glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT))
-
         if(m_cache.alpha_threshold > 0.f)
         {
             spCheck(glEnable(GL_ALPHA_TEST))
             spCheck(glAlphaFunc(GL_GREATER, m_cache.alpha_threshold))
         }
-        spCheck(glVertexPointer(2, GL_FLOAT, 0, &m_positions[0]));
-        spCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &m_colors[0]));
-        spCheck(glTexCoordPointer(2, GL_FLOAT, 0, &m_tex_coords[0]));
+        //per-drawable shader parameters, so drawables sharing a shader stay in one batch..
+        const bool user_data = Shader::shader_objects_supported();
+        if(user_data)
+            spCheck(glEnableVertexAttribArrayARB(Shader::UserData))
+        if(transform_shader)
+            spCheck(glEnableVertexAttribArrayARB(Shader::Slot))
+        pointArrays(0, transform_shader != nullptr);
 
         /*
         static const sp::Texture*   texture    = nullptr;
         static const sp::Shader*    shader     = nullptr;
         */
         static unsigned int tex_obj        = 0;
-        static unsigned int shader_obj     = 0;
 
                const Viewport*      viewport   = &m_default_view;
         static bool                 lighting   = false;
@@ -1078,8 +1709,18 @@ namespace sp
          */
 
         //this draws the plain scene without any post-effects..
+        const rectf view_area = m_current_view ? rectf{m_current_view->viewport.getOrigin(), m_current_view->viewport.getSize()} : rectf{};
         for(auto& batch : m_batches)
         {
+            //custom draws in world space are replayed per view like the rest..
+            const bool overlay = isOverlay(batch.states.viewport);
+            if(!(pass & (overlay ? PassOverlay : PassWorld)))
+                continue;
+
+            //whole batches outside of the view are left out..
+            if(m_current_view && batch.bounded && !batch.bounds.intersects(view_area))
+                continue;
+
             if(batch.states.custom_draw_enable)
             {
                 //tested..
@@ -1095,11 +1736,16 @@ namespace sp
                 spCheck(glMatrixMode(GL_MODELVIEW))
                 resetStatesGL();
 
-                if(batch.states.viewport && !batch.states.viewport->defaulted())
+                //resetStatesGL falls back to the default viewport, the current view is loaded again..
+                if(overlay)
                 {
                     batch.states.viewport->load();
                     m_cache.viewport_change = true;
                 }
+                else
+                {
+                    applyCurrentView();
+                }
 
                 if(batch.states.custom_draw_fn)
                     batch.states.custom_draw_fn();
@@ -1116,6 +1762,10 @@ namespace sp
                 spCheck(glMatrixMode(GL_MODELVIEW))
                 spCheck(glPopClientAttrib())
                 spCheck(glPopAttrib())
+
+                //glPopAttrib leaves the program alone, whatever the callback bound stays..
+                sp::Shader::bind(nullptr);
+                m_cache.last_shader = nullptr;
             }
             else
             {
@@ -1130,15 +1780,29 @@ namespace sp
                     applyTexture(batch.states.texture);
                 }
 
-                unsigned int batch_shader = batch.states.shader ? batch.states.shader->getHandleGL() : 0;
-                if(batch_shader != shader_obj)
+                //checked against m_cache, which custom draws keep honest..
+                const Shader* shader = batch.states.shader ? batch.states.shader : transform_shader;
+                applyShader(shader);
+
+                if(shader && shader == transform_shader)
                 {
-                    shader_obj = batch_shader;
-                    applyShader(batch.states.shader);
+                    m_transforms.resize(batch.transform_count);
+                    for(size_t i = 0; i < batch.transform_count; ++i)
+                    {
+                        Drawable::DrawableStates* ptr = Drawable::lookup(m_transform_handles[batch.transform_first + i]);
+                        vec2f position = ptr ? ptr->position : vec2f{0.f, 0.f};
+                        m_transforms[i] = gl::vec4f(position.x, position.y, 0.f, 0.f);
+                    }
+
+                    if(!m_transforms.empty())
+                        transform_shader->setUniformArray(m_transforms_uniform, m_transforms.data(), m_transforms.size());
+                    const Texture* texture = batch.states.texture;
+                    transform_shader->setUniform(m_textured_uniform, !texture ? 0.f : texture->isAlphaOnly() ? 2.f : 1.f);
+                    transform_shader->flushUniforms();
                 }
 
                 viewport = batch.states.viewport;
-                if(viewport && !viewport->defaulted() && *viewport != m_default_view)
+                if(isOverlay(viewport))
                 {
                     viewport->load();
                     m_cache.viewport_change = true;
@@ -1184,7 +1848,23 @@ namespace sp
                     }
                 }
                 //printf("index start: %lld index count: %lld, index cache: %lld\n", batch.index_start, batch.index_count, m_indices.size());
-                spCheck(glDrawElements(batch.states.primitive_type, batch.index_count, GL_UNSIGNED_INT, (void*)(&m_indices[0] + batch.index_start)))
+                if(batch.quads)
+                {
+                    //ranges starting off a multiple of four get the arrays moved instead..
+                    bool aligned = !(batch.vertex_start % 4);
+                    if(!aligned)
+                        pointArrays(batch.vertex_start, transform_shader != nullptr);
+
+                    const unsigned int* first = m_quad_indices.data() + (aligned ? batch.vertex_start / 4 * 6 : 0);
+                    spCheck(glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(batch.quad_count * 6), GL_UNSIGNED_INT, first))
+
+                    if(!aligned)
+                        pointArrays(0, transform_shader != nullptr);
+                }
+                else
+                {
+                    spCheck(glDrawElements(batch.states.primitive_type, batch.index_count, GL_UNSIGNED_INT, (void*)(m_indices.data() + batch.index_start)))
+                }
 
                 if(batch.states.primitive_type == GL_POINTS)
                 {
@@ -1206,11 +1886,70 @@ namespace sp
             spCheck(glDisable(GL_ALPHA_TEST))
             spCheck(glAlphaFunc(GL_GREATER, 0.f))
         }
+        if(user_data)
+            spCheck(glDisableVertexAttribArrayARB(Shader::UserData))
+        if(transform_shader)
+            spCheck(glDisableVertexAttribArrayARB(Shader::Slot))
+
+        //immediate draws of this frame go on top of the scene..
+        flushImmediate(pass);
+    }
+
+    /*
+     *  1. draw scene to fbo..
+     *  2. draw color attachment to screen..
+     *  3. draw radial gradient to fbo..
+     *  4. draw color attachment to screen..
+     */
+    void Renderer::draw()
+    {
+        //printf("ok 1..\n");
+        refresh();
+
+        if((!m_index_count || m_indices.empty()) && m_batches.empty() && m_immediate_draws.empty())
+        {
+            return;
+        }
+        //printf("pos: %lld, colors: %lld, tcs: %lld\n", m_positions.size(), m_colors.size(), m_tex_coords.size());
+        setupDraw();
+        spCheck(glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT | GL_CLIENT_VERTEX_ARRAY_BIT))
+        spCheck(glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT))
+
+        //drawables without a shader are translated by the transform shader..
+        Shader* transform_shader = m_transform_shader.get();
+        if(transform_shader && m_slots.size() != m_positions.size())
+            transform_shader = nullptr;
+
+        if(m_views.empty())
+        {
+            drawPass(transform_shader, PassAll);
+        }
+        else
+        {
+            //refreshed and sorted once above, every view only replays the batches..
+            boundBatches();
+            for(const View& view : m_views)
+            {
+                m_current_view = &view;
+                applyCurrentView();
+                drawPass(transform_shader, PassWorld);
+            }
+
+            m_current_view = nullptr;
+            spCheck(glScissor(0, 0, m_size.x, m_size.y))
+            applyCurrentView();
+            drawPass(transform_shader, PassOverlay);
+        }
+
         spCheck(glPopAttrib())
         spCheck(glPopClientAttrib())
 
         m_primary_framebuffer.display();
 
+        //the resolved frame is read back before the post-process pass..
+        if(m_frame_capture)
+            m_frame_capture->update(m_primary_framebuffer);
+
         spCheck(glClearColor(0.f, 0.f, 0.f, 0.f))
         spCheck(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT))
 
@@ -22,6 +22,17 @@ namespace sp
         Blending::Add,
     };
 
+    //for premultiplied colours; additive when the source alpha is zero..
+    const Blending BlendPremultiplied
+    {
+        Blending::One,
+        Blending::OneMinusSrcAlpha,
+        Blending::Add,
+        Blending::One,
+        Blending::OneMinusSrcAlpha,
+        Blending::Add
+    };
+
     const Blending BlendMultiply
     {
         Blending::DstColor,
@@ -0,0 +1,821 @@
+#include <sp/gxsp/compressed_image.h>
+#include <sp/utils/helpers.h>
+#include <algorithm>
+#include <cstring>
+
+namespace sp
+{
+    namespace
+    {
+        const char      container_magic[4]  = {'S', 'P', 'T', 'C'};
+        const SPuint32  container_version   = 1;
+        const size_t    header_size         = 6 * sizeof(SPuint32);
+        const size_t    payload_alignment   = 16;
+
+        //bc7 interpolation weights..
+        const int weights2[4]  = {0, 21, 43, 64};
+        const int weights3[8]  = {0, 9, 18, 27, 37, 46, 55, 64};
+        const int weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        SPuint32 read_u32(const SPuint8* data)
+        {
+            return  static_cast<SPuint32>(data[0])
+                 | (static_cast<SPuint32>(data[1]) << 8)
+                 | (static_cast<SPuint32>(data[2]) << 16)
+                 | (static_cast<SPuint32>(data[3]) << 24);
+        }
+
+        void write_u32(SPuint8* data, SPuint32 value)
+        {
+            data[0] = static_cast<SPuint8>(value);
+            data[1] = static_cast<SPuint8>(value >> 8);
+            data[2] = static_cast<SPuint8>(value >> 16);
+            data[3] = static_cast<SPuint8>(value >> 24);
+        }
+
+        SPuint16 read_u16(const SPuint8* data)
+        {
+            return static_cast<SPuint16>(data[0] | (data[1] << 8));
+        }
+
+        struct BitReader
+        {
+            const SPuint8*  data;
+            unsigned int    position;
+
+            unsigned int read(unsigned int count)
+            {
+                unsigned int value = 0;
+                for(unsigned int i = 0; i < count; ++i, ++position)
+                    value |= ((data[position >> 3] >> (position & 7)) & 1u) << i;
+                return value;
+            }
+        };
+
+        struct BitWriter
+        {
+            SPuint8*        data;
+            unsigned int    position;
+
+            void write(unsigned int value, unsigned int count)
+            {
+                for(unsigned int i = 0; i < count; ++i, ++position)
+                {
+                    if((value >> i) & 1u)
+                        data[position >> 3] |= static_cast<SPuint8>(1u << (position & 7));
+                }
+            }
+        };
+
+        int interpolate(int e0, int e1, int weight)
+        {
+            return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+        }
+
+        void unpack565(SPuint16 c, int* rgb)
+        {
+            int r = (c >> 11) & 31;
+            int g = (c >> 5)  & 63;
+            int b =  c        & 31;
+            rgb[0] = (r << 3) | (r >> 2);
+            rgb[1] = (g << 2) | (g >> 4);
+            rgb[2] = (b << 3) | (b >> 2);
+        }
+
+        SPuint16 pack565(const int* rgb)
+        {
+            int r = (rgb[0] * 31 + 127) / 255;
+            int g = (rgb[1] * 63 + 127) / 255;
+            int b = (rgb[2] * 31 + 127) / 255;
+            return static_cast<SPuint16>((r << 11) | (g << 5) | b);
+        }
+
+        int distance(const int* a, const int* b, int channels)
+        {
+            int d = 0;
+            for(int i = 0; i < channels; ++i)
+                d += (a[i] - b[i]) * (a[i] - b[i]);
+            return d;
+        }
+
+        //decodes the color half of a dxt block..
+        void decode_color(const SPuint8* block, SPuint8* out, bool allow_transparent)
+        {
+            SPuint16 c0 = read_u16(block);
+            SPuint16 c1 = read_u16(block + 2);
+            SPuint32 indices = read_u32(block + 4);
+
+            int palette[4][4];
+            unpack565(c0, palette[0]);
+            unpack565(c1, palette[1]);
+            palette[0][3] = palette[1][3] = 255;
+
+            if(c0 > c1 || !allow_transparent)
+            {
+                for(int c = 0; c < 3; ++c)
+                {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+                palette[2][3] = palette[3][3] = 255;
+            }
+            else
+            {
+                for(int c = 0; c < 3; ++c)
+                {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+                palette[2][3] = 255;
+                palette[3][3] = 0;
+            }
+
+            for(int i = 0; i < 16; ++i)
+            {
+                const int* color = palette[(indices >> (2 * i)) & 3];
+                out[4 * i + 0] = static_cast<SPuint8>(color[0]);
+                out[4 * i + 1] = static_cast<SPuint8>(color[1]);
+                out[4 * i + 2] = static_cast<SPuint8>(color[2]);
+                out[4 * i + 3] = static_cast<SPuint8>(color[3]);
+            }
+        }
+
+        //decodes the interpolated alpha half of a dxt5 block..
+        void decode_alpha(const SPuint8* block, SPuint8* out)
+        {
+            int a0 = block[0];
+            int a1 = block[1];
+            int palette[8] = {a0, a1};
+            if(a0 > a1)
+            {
+                for(int i = 1; i < 7; ++i)
+                    palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+            }
+            else
+            {
+                for(int i = 1; i < 5; ++i)
+                    palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+
+            SPuint64 indices = 0;
+            for(int i = 0; i < 6; ++i)
+                indices |= static_cast<SPuint64>(block[2 + i]) << (8 * i);
+
+            for(int i = 0; i < 16; ++i)
+                out[4 * i + 3] = static_cast<SPuint8>(palette[(indices >> (3 * i)) & 7]);
+        }
+
+        //only the single-subset modes (4 to 6) are decoded, the partitioned ones
+        //need the partition tables and are left to the driver..
+        bool decode_bc7(const SPuint8* block, SPuint8* out)
+        {
+            int mode = 0;
+            while(mode < 8 && !((block[0] >> mode) & 1))
+                mode++;
+
+            if(mode < 4 || mode > 6)
+                return false;
+
+            BitReader reader{block, static_cast<unsigned int>(mode + 1)};
+            int e0[4];
+            int e1[4];
+            int rotation = 0;
+            int color_index[16];
+            int alpha_index[16];
+            const int* color_weights = weights2;
+            const int* alpha_weights = weights2;
+
+            if(mode == 6)
+            {
+                for(int c = 0; c < 4; ++c)
+                {
+                    e0[c] = reader.read(7);
+                    e1[c] = reader.read(7);
+                }
+                int p0 = reader.read(1);
+                int p1 = reader.read(1);
+                for(int c = 0; c < 4; ++c)
+                {
+                    e0[c] = (e0[c] << 1) | p0;
+                    e1[c] = (e1[c] << 1) | p1;
+                }
+
+                for(int i = 0; i < 16; ++i)
+                    color_index[i] = alpha_index[i] = reader.read(i == 0 ? 3 : 4);
+                color_weights = alpha_weights = weights4;
+            }
+            else if(mode == 5)
+            {
+                rotation = reader.read(2);
+                for(int c = 0; c < 3; ++c)
+                {
+                    e0[c] = reader.read(7);
+                    e1[c] = reader.read(7);
+                    e0[c] = (e0[c] << 1) | (e0[c] >> 6);
+                    e1[c] = (e1[c] << 1) | (e1[c] >> 6);
+                }
+                e0[3] = reader.read(8);
+                e1[3] = reader.read(8);
+
+                for(int i = 0; i < 16; ++i)
+                    color_index[i] = reader.read(i == 0 ? 1 : 2);
+                for(int i = 0; i < 16; ++i)
+                    alpha_index[i] = reader.read(i == 0 ? 1 : 2);
+            }
+            else
+            {
+                rotation = reader.read(2);
+                int index_mode = reader.read(1);
+                for(int c = 0; c < 3; ++c)
+                {
+                    e0[c] = reader.read(5);
+                    e1[c] = reader.read(5);
+                    e0[c] = (e0[c] << 3) | (e0[c] >> 2);
+                    e1[c] = (e1[c] << 3) | (e1[c] >> 2);
+                }
+                e0[3] = reader.read(6);
+                e1[3] = reader.read(6);
+                e0[3] = (e0[3] << 2) | (e0[3] >> 4);
+                e1[3] = (e1[3] << 2) | (e1[3] >> 4);
+
+                int narrow[16];
+                int wide[16];
+                for(int i = 0; i < 16; ++i)
+                    narrow[i] = reader.read(i == 0 ? 1 : 2);
+                for(int i = 0; i < 16; ++i)
+                    wide[i] = reader.read(i == 0 ? 2 : 3);
+
+                for(int i = 0; i < 16; ++i)
+                {
+                    color_index[i] = index_mode ? wide[i] : narrow[i];
+                    alpha_index[i] = index_mode ? narrow[i] : wide[i];
+                }
+                color_weights = index_mode ? weights3 : weights2;
+                alpha_weights = index_mode ? weights2 : weights3;
+            }
+
+            for(int i = 0; i < 16; ++i)
+            {
+                int texel[4];
+                for(int c = 0; c < 3; ++c)
+                    texel[c] = interpolate(e0[c], e1[c], color_weights[color_index[i]]);
+                texel[3] = interpolate(e0[3], e1[3], alpha_weights[alpha_index[i]]);
+
+                if(rotation)
+                    std::swap(texel[3], texel[rotation - 1]);
+
+                for(int c = 0; c < 4; ++c)
+                    out[4 * i + c] = static_cast<SPuint8>(texel[c]);
+            }
+            return true;
+        }
+
+        void encode_color(const SPuint8* texels, SPuint8* block, bool allow_transparent)
+        {
+            int lo[3] = {255, 255, 255};
+            int hi[3] = {0, 0, 0};
+            bool transparent = false;
+            for(int i = 0; i < 16; ++i)
+            {
+                if(allow_transparent && texels[4 * i + 3] < 128)
+                {
+                    transparent = true;
+                    continue;
+                }
+
+                for(int c = 0; c < 3; ++c)
+                {
+                    lo[c] = std::min<int>(lo[c], texels[4 * i + c]);
+                    hi[c] = std::max<int>(hi[c], texels[4 * i + c]);
+                }
+            }
+
+            if(lo[0] > hi[0])
+            {
+                //fully transparent block..
+                std::memset(block, 0, 4);
+                std::memset(block + 4, 0xff, 4);
+                return;
+            }
+
+            //inset the bounding box a little, the endpoints are rarely hit exactly..
+            for(int c = 0; c < 3; ++c)
+            {
+                int inset = (hi[c] - lo[c]) >> 4;
+                lo[c] += inset;
+                hi[c] -= inset;
+            }
+
+            SPuint16 c0 = pack565(hi);
+            SPuint16 c1 = pack565(lo);
+
+            //four color blocks need c0 > c1, three color blocks c0 <= c1..
+            if(transparent ? (c0 > c1) : (c0 < c1))
+                std::swap(c0, c1);
+
+            int palette[4][3];
+            unpack565(c0, palette[0]);
+            unpack565(c1, palette[1]);
+            int colors = 4;
+            if(transparent || c0 == c1)
+            {
+                for(int c = 0; c < 3; ++c)
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                colors = 3;
+            }
+            else
+            {
+                for(int c = 0; c < 3; ++c)
+                {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+            }
+
+            SPuint32 indices = 0;
+            for(int i = 0; i < 16; ++i)
+            {
+                int index = 0;
+                if(transparent && texels[4 * i + 3] < 128)
+                {
+                    index = 3;
+                }
+                else
+                {
+                    int texel[3] = {texels[4 * i], texels[4 * i + 1], texels[4 * i + 2]};
+                    int best = distance(texel, palette[0], 3);
+                    for(int p = 1; p < colors; ++p)
+                    {
+                        int d = distance(texel, palette[p], 3);
+                        if(d < best)
+                        {
+                            best  = d;
+                            index = p;
+                        }
+                    }
+                }
+                indices |= static_cast<SPuint32>(index) << (2 * i);
+            }
+
+            block[0] = static_cast<SPuint8>(c0);
+            block[1] = static_cast<SPuint8>(c0 >> 8);
+            block[2] = static_cast<SPuint8>(c1);
+            block[3] = static_cast<SPuint8>(c1 >> 8);
+            write_u32(block + 4, indices);
+        }
+
+        void encode_alpha(const SPuint8* texels, SPuint8* block)
+        {
+            int a0 = 0;
+            int a1 = 255;
+            for(int i = 0; i < 16; ++i)
+            {
+                a0 = std::max<int>(a0, texels[4 * i + 3]);
+                a1 = std::min<int>(a1, texels[4 * i + 3]);
+            }
+
+            std::memset(block, 0, 8);
+            block[0] = static_cast<SPuint8>(a0);
+            block[1] = static_cast<SPuint8>(a1);
+            if(a0 == a1)
+                return;
+
+            int palette[8] = {a0, a1};
+            for(int i = 1; i < 7; ++i)
+                palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+
+            SPuint64 indices = 0;
+            for(int i = 0; i < 16; ++i)
+            {
+                int alpha = texels[4 * i + 3];
+                int index = 0;
+                int best  = 256;
+                for(int p = 0; p < 8; ++p)
+                {
+                    int d = std::abs(alpha - palette[p]);
+                    if(d < best)
+                    {
+                        best  = d;
+                        index = p;
+                    }
+                }
+                indices |= static_cast<SPuint64>(index) << (3 * i);
+            }
+
+            for(int i = 0; i < 6; ++i)
+                block[2 + i] = static_cast<SPuint8>(indices >> (8 * i));
+        }
+
+        void encode_explicit_alpha(const SPuint8* texels, SPuint8* block)
+        {
+            std::memset(block, 0, 8);
+            for(int i = 0; i < 16; ++i)
+            {
+                int alpha = (texels[4 * i + 3] + 8) / 17;
+                block[i >> 1] |= static_cast<SPuint8>(alpha << (4 * (i & 1)));
+            }
+        }
+
+        //quantizes an 8 bit endpoint to 7 bits plus a shared p-bit..
+        int quantize_endpoint(const int* color, int* quantized)
+        {
+            int best_bit   = 0;
+            int best_error = -1;
+            for(int bit = 0; bit < 2; ++bit)
+            {
+                int error = 0;
+                int q[4];
+                for(int c = 0; c < 4; ++c)
+                {
+                    q[c] = std::max(0, std::min(127, (color[c] - bit + 1) >> 1));
+                    int value = (q[c] << 1) | bit;
+                    error += (value - color[c]) * (value - color[c]);
+                }
+
+                if(best_error < 0 || error < best_error)
+                {
+                    best_error = error;
+                    best_bit   = bit;
+                    std::copy(q, q + 4, quantized);
+                }
+            }
+            return best_bit;
+        }
+
+        //mode 6, a single rgba subset with 4 bit indices..
+        void encode_bc7(const SPuint8* texels, SPuint8* block)
+        {
+            int lo[4] = {255, 255, 255, 255};
+            int hi[4] = {0, 0, 0, 0};
+            for(int i = 0; i < 16; ++i)
+            {
+                for(int c = 0; c < 4; ++c)
+                {
+                    lo[c] = std::min<int>(lo[c], texels[4 * i + c]);
+                    hi[c] = std::max<int>(hi[c], texels[4 * i + c]);
+                }
+            }
+
+            int q0[4];
+            int q1[4];
+            int p0 = quantize_endpoint(lo, q0);
+            int p1 = quantize_endpoint(hi, q1);
+
+            int e0[4];
+            int e1[4];
+            for(int c = 0; c < 4; ++c)
+            {
+                e0[c] = (q0[c] << 1) | p0;
+                e1[c] = (q1[c] << 1) | p1;
+            }
+
+            int palette[16][4];
+            for(int i = 0; i < 16; ++i)
+                for(int c = 0; c < 4; ++c)
+                    palette[i][c] = interpolate(e0[c], e1[c], weights4[i]);
+
+            int indices[16];
+            for(int i = 0; i < 16; ++i)
+            {
+                int texel[4] = {texels[4 * i], texels[4 * i + 1], texels[4 * i + 2], texels[4 * i + 3]};
+                int best = distance(texel, palette[0], 4);
+                indices[i] = 0;
+                for(int p = 1; p < 16; ++p)
+                {
+                    int d = distance(texel, palette[p], 4);
+                    if(d < best)
+                    {
+                        best = d;
+                        indices[i] = p;
+                    }
+                }
+            }
+
+            //the anchor index drops its top bit, so it must stay below 8..
+            if(indices[0] >= 8)
+            {
+                std::swap(q0, q1);
+                std::swap(p0, p1);
+                for(int i = 0; i < 16; ++i)
+                    indices[i] = 15 - indices[i];
+            }
+
+            std::memset(block, 0, 16);
+            BitWriter writer{block, 0};
+            writer.write(1u << 6, 7);
+            for(int c = 0; c < 4; ++c)
+            {
+                writer.write(q0[c], 7);
+                writer.write(q1[c], 7);
+            }
+            writer.write(p0, 1);
+            writer.write(p1, 1);
+            for(int i = 0; i < 16; ++i)
+                writer.write(indices[i], i == 0 ? 3 : 4);
+        }
+
+        void downsample(const SPuint8* src, unsigned int width, unsigned int height, SPuint8* dst)
+        {
+            unsigned int w = std::max(1u, width  >> 1);
+            unsigned int h = std::max(1u, height >> 1);
+            for(unsigned int y = 0; y < h; ++y)
+            {
+                unsigned int y0 = std::min(2 * y,     height - 1);
+                unsigned int y1 = std::min(2 * y + 1, height - 1);
+                for(unsigned int x = 0; x < w; ++x)
+                {
+                    unsigned int x0 = std::min(2 * x,     width - 1);
+                    unsigned int x1 = std::min(2 * x + 1, width - 1);
+                    for(unsigned int c = 0; c < 4; ++c)
+                    {
+                        unsigned int sum = src[4 * (y0 * width + x0) + c]
+                                         + src[4 * (y0 * width + x1) + c]
+                                         + src[4 * (y1 * width + x0) + c]
+                                         + src[4 * (y1 * width + x1) + c];
+                        dst[4 * (y * w + x) + c] = static_cast<SPuint8>((sum + 2) >> 2);
+                    }
+                }
+            }
+        }
+    }
+
+    CompressedImage::CompressedImage() :
+        m_format    {DXT1},
+        m_size      {0, 0}
+    {
+    }
+
+    bool CompressedImage::loadFromFile(const char* filename)
+    {
+        size_t size = 0;
+        SPuint8* data = reinterpret_cast<SPuint8*>(spHelperFileData(filename, &size));
+        if(!data)
+        {
+            SP_PRINT_WARNING("failed to load file " << filename);
+            return false;
+        }
+
+        std::vector<SPuint8> storage(data, data + size);
+        free(data);
+
+        if(!loadFromMemory(storage.data(), storage.size()))
+            return false;
+
+        //levels point into the vector's buffer, which survives the move..
+        m_storage = std::move(storage);
+        return true;
+    }
+
+    bool CompressedImage::loadFromMemory(const void* data, size_t size)
+    {
+        if(!isCompressedImage(data, size))
+        {
+            SP_PRINT_WARNING("data is not a compressed image container");
+            return false;
+        }
+
+        const SPuint8* bytes = reinterpret_cast<const SPuint8*>(data);
+        SPuint32 version = read_u32(bytes + 4);
+        SPuint32 format  = read_u32(bytes + 8);
+        SPuint32 width   = read_u32(bytes + 12);
+        SPuint32 height  = read_u32(bytes + 16);
+        SPuint32 levels  = read_u32(bytes + 20);
+
+        if(version != container_version)
+        {
+            SP_PRINT_WARNING("unsupported compressed image version " << version);
+            return false;
+        }
+
+        if(format < DXT1 || format > BC7 || !width || !height || !levels || levels > 32)
+        {
+            SP_PRINT_WARNING("malformed compressed image header");
+            return false;
+        }
+
+        if(size < header_size + levels * 2 * sizeof(SPuint32))
+        {
+            SP_PRINT_WARNING("truncated compressed image");
+            return false;
+        }
+
+        std::vector<Level> table(levels);
+        unsigned int w = width;
+        unsigned int h = height;
+        for(SPuint32 i = 0; i < levels; ++i)
+        {
+            const SPuint8* entry = bytes + header_size + i * 2 * sizeof(SPuint32);
+            size_t offset = read_u32(entry);
+            size_t length = read_u32(entry + 4);
+
+            if(offset + length > size || length != getLevelSize(static_cast<SP_Format>(format), w, h))
+            {
+                SP_PRINT_WARNING("malformed compressed image level " << i);
+                return false;
+            }
+
+            table[i] = Level{w, h, bytes + offset, length};
+            w = std::max(1u, w >> 1);
+            h = std::max(1u, h >> 1);
+        }
+
+        m_storage.clear();
+        m_levels = std::move(table);
+        m_format = static_cast<SP_Format>(format);
+        m_size   = {width, height};
+        return true;
+    }
+
+    CompressedImage::SP_Format CompressedImage::getFormat() const
+    {
+        return m_format;
+    }
+
+    const vec2u& CompressedImage::getSize() const
+    {
+        return m_size;
+    }
+
+    unsigned int CompressedImage::getLevelCount() const
+    {
+        return static_cast<unsigned int>(m_levels.size());
+    }
+
+    const CompressedImage::Level& CompressedImage::getLevel(unsigned int level) const
+    {
+        SP_ASSERT(level < m_levels.size(), "mip level out of range");
+        return m_levels[level];
+    }
+
+    bool CompressedImage::isCompressedImage(const void* data, size_t size)
+    {
+        return data && size >= header_size && std::memcmp(data, container_magic, 4) == 0;
+    }
+
+    size_t CompressedImage::getBlockSize(SP_Format format)
+    {
+        return format == DXT1 ? 8 : 16;
+    }
+
+    size_t CompressedImage::getLevelSize(SP_Format format, unsigned int width, unsigned int height)
+    {
+        return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+    }
+
+    bool CompressedImage::decompress(SP_Format format, const void* blocks, unsigned int width, unsigned int height, SPuint8* rgba)
+    {
+        const SPuint8* block = reinterpret_cast<const SPuint8*>(blocks);
+        const size_t   block_size = getBlockSize(format);
+
+        SPuint8 texels[64];
+        for(unsigned int by = 0; by < height; by += 4)
+        {
+            for(unsigned int bx = 0; bx < width; bx += 4, block += block_size)
+            {
+                switch(format)
+                {
+                    case DXT1:
+                        decode_color(block, texels, true);
+                        break;
+
+                    case DXT3:
+                        decode_color(block + 8, texels, false);
+                        for(int i = 0; i < 16; ++i)
+                            texels[4 * i + 3] = static_cast<SPuint8>(((block[i >> 1] >> (4 * (i & 1))) & 15) * 17);
+                        break;
+
+                    case DXT5:
+                        decode_color(block + 8, texels, false);
+                        decode_alpha(block, texels);
+                        break;
+
+                    case BC7:
+                        if(!decode_bc7(block, texels))
+                        {
+                            SP_PRINT_WARNING("cannot decode partitioned bc7 blocks on the cpu");
+                            return false;
+                        }
+                        break;
+
+                    default:
+                        return false;
+                }
+
+                //blocks on the right and bottom edges are clipped..
+                unsigned int w = std::min(4u, width  - bx);
+                unsigned int h = std::min(4u, height - by);
+                for(unsigned int y = 0; y < h; ++y)
+                    std::memcpy(rgba + 4 * ((by + y) * width + bx), texels + 16 * y, 4 * w);
+            }
+        }
+        return true;
+    }
+
+    bool CompressedImage::compress(SP_Format format, const SPuint8* rgba, unsigned int width, unsigned int height, SPuint8* blocks)
+    {
+        const size_t block_size = getBlockSize(format);
+
+        SPuint8 texels[64];
+        for(unsigned int by = 0; by < height; by += 4)
+        {
+            for(unsigned int bx = 0; bx < width; bx += 4, blocks += block_size)
+            {
+                //edge blocks repeat the last row and column..
+                for(unsigned int y = 0; y < 4; ++y)
+                {
+                    unsigned int sy = std::min(by + y, height - 1);
+                    for(unsigned int x = 0; x < 4; ++x)
+                    {
+                        unsigned int sx = std::min(bx + x, width - 1);
+                        std::memcpy(texels + 4 * (4 * y + x), rgba + 4 * (sy * width + sx), 4);
+                    }
+                }
+
+                switch(format)
+                {
+                    case DXT1:
+                        encode_color(texels, blocks, true);
+                        break;
+
+                    case DXT3:
+                        encode_explicit_alpha(texels, blocks);
+                        encode_color(texels, blocks + 8, false);
+                        break;
+
+                    case DXT5:
+                        encode_alpha(texels, blocks);
+                        encode_color(texels, blocks + 8, false);
+                        break;
+
+                    case BC7:
+                        encode_bc7(texels, blocks);
+                        break;
+
+                    default:
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    std::vector<SPuint8> CompressedImage::createContainer(SP_Format format, const SPuint8* rgba, unsigned int width, unsigned int height, bool mipmaps)
+    {
+        std::vector<SPuint8> container;
+        if(!rgba || !width || !height)
+            return container;
+
+        SPuint32 levels = 1;
+        if(mipmaps)
+        {
+            while((std::max(width, height) >> levels) > 0)
+                levels++;
+        }
+
+        //header and level table..
+        size_t offset = header_size + levels * 2 * sizeof(SPuint32);
+        std::vector<size_t> offsets(levels);
+        unsigned int w = width;
+        unsigned int h = height;
+        for(SPuint32 i = 0; i < levels; ++i)
+        {
+            offset = (offset + payload_alignment - 1) & ~(payload_alignment - 1);
+            offsets[i] = offset;
+            offset += getLevelSize(format, w, h);
+            w = std::max(1u, w >> 1);
+            h = std::max(1u, h >> 1);
+        }
+
+        container.resize(offset, 0);
+        std::memcpy(container.data(), container_magic, 4);
+        write_u32(container.data() + 4,  container_version);
+        write_u32(container.data() + 8,  format);
+        write_u32(container.data() + 12, width);
+        write_u32(container.data() + 16, height);
+        write_u32(container.data() + 20, levels);
+
+        std::vector<SPuint8> current(rgba, rgba + static_cast<size_t>(width) * height * 4);
+        std::vector<SPuint8> next;
+        w = width;
+        h = height;
+        for(SPuint32 i = 0; i < levels; ++i)
+        {
+            SPuint8* entry = container.data() + header_size + i * 2 * sizeof(SPuint32);
+            write_u32(entry,     static_cast<SPuint32>(offsets[i]));
+            write_u32(entry + 4, static_cast<SPuint32>(getLevelSize(format, w, h)));
+            compress(format, current.data(), w, h, container.data() + offsets[i]);
+
+            if(i + 1 < levels)
+            {
+                next.resize(static_cast<size_t>(std::max(1u, w >> 1)) * std::max(1u, h >> 1) * 4);
+                downsample(current.data(), w, h, next.data());
+                current.swap(next);
+                w = std::max(1u, w >> 1);
+                h = std::max(1u, h >> 1);
+            }
+        }
+        return container;
+    }
+}
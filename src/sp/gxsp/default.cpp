@@ -45,41 +45,16 @@ const void* loadDefaultIcon()
     return bitmap_data;
 }
 
-const void* loadDefaultFont()
+const void* loadDefaultFont(size_t* size)
 {
-    static const size_t length = 489484L;
-    static char font_data[length];
-    static bool font_data_decoded = false;
-
-    if(!font_data_decoded)
-    {
-        font_data_decoded = true;
-        unsigned char input_block[4];
-		static const std::string base64_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-        size_t font_data_encoded_counter = length / 3 * 4;
-        size_t font_data_decoded_counter = 0;
-
-        const char* font_data_ptr = reinterpret_cast<const char*>(arial_glyph_cipher);
-
-        for(size_t index = 0; index < font_data_encoded_counter; index += 4)
-        {
-            if(!font_data_ptr[index])
-            {
-                index++;
-                font_data_encoded_counter++;
-            }
-
-            input_block[0] = static_cast<unsigned char>(base64_chars.find(font_data_ptr[index + 0]));
-            input_block[1] = static_cast<unsigned char>(base64_chars.find(font_data_ptr[index + 1]));
-            input_block[2] = static_cast<unsigned char>(base64_chars.find(font_data_ptr[index + 2]));
-            input_block[3] = static_cast<unsigned char>(base64_chars.find(font_data_ptr[index + 3]));
-            font_data[font_data_decoded_counter + 0] = static_cast<char>((input_block[0] << 2) | ((input_block[1] & 0x30) >> 4));
-            font_data[font_data_decoded_counter + 1] = static_cast<char>(((input_block[1] & 0xf) << 4) | ((input_block[2] & 0x3c) >> 2));
-            font_data[font_data_decoded_counter + 2] = static_cast<char>(((input_block[2] & 0x3) << 6) | input_block[3]);
-            font_data_decoded_counter += 3;
-        }
-    }
+    //embedded as raw bytes by tools/spembed.cpp, nothing to decode..
+    if(size)
+        *size = default_font_size;
+    return default_font_data;
+}
 
-    return font_data;
+const SP_Baked_Font* loadDefaultBakedFont()
+{
+    return &default_font_baked;
 }
 }
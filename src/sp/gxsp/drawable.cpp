@@ -4,6 +4,7 @@
 #include <sp/gxsp/texture.h>
 #include <sp/gxsp/blending.h>
 #include <sp/gxsp/batch_renderer.h>
+#include <sp/gxsp/mesh_builder.h>
 #include <sp/exception.h>
 
 namespace sp
@@ -74,17 +75,149 @@ namespace sp
             ))
         }
     }
+    class Drawable::StatesPool
+    {
+        public:
+            static StatesPool& instance()
+            {
+                static StatesPool pool;
+                return pool;
+            }
+
+            Handle create()
+            {
+                if(m_free.empty())
+                    grow();
+
+                SPuint32 index = m_free.back();
+                m_free.pop_back();
+
+                Record& record = at(index);
+                record.refs = 1;
+                return Handle{index, record.version};
+            }
+
+            void retain(Handle handle)
+            {
+                Record* record = find(handle);
+                if(record)
+                    ++record->refs;
+            }
+
+            void release(Handle handle)
+            {
+                Record* record = find(handle);
+                if(!record || --record->refs)
+                    return;
+
+                record->states = DrawableStates{};
+                if(!++record->version)
+                    record->version = 1;
+                m_free.push_back(handle.index);
+            }
+
+            DrawableStates* get(Handle handle)
+            {
+                Record* record = find(handle);
+                return record ? &record->states : nullptr;
+            }
+
+        private:
+            struct Record
+            {
+                DrawableStates  states;
+                SPuint32        version;
+                SPuint32        refs;
+            };
+
+            static const SPuint32 chunk_size = 1024;
+
+            Record& at(SPuint32 index)
+            {
+                return m_chunks[index / chunk_size][index % chunk_size];
+            }
+
+            Record* find(Handle handle)
+            {
+                if(handle.index >= m_chunks.size() * chunk_size)
+                    return nullptr;
+
+                Record& record = at(handle.index);
+                return (record.refs && record.version == handle.version) ? &record : nullptr;
+            }
+
+            void grow()
+            {
+                SPuint32 first = static_cast<SPuint32>(m_chunks.size()) * chunk_size;
+                m_chunks.emplace_back(new Record[chunk_size]);
+
+                //lowest indices are handed out first..
+                m_free.reserve(m_free.size() + chunk_size);
+                for(SPuint32 i = chunk_size; i > 0; --i)
+                {
+                    Record& record = at(first + i - 1);
+                    record.version = 1;
+                    record.refs    = 0;
+                    m_free.push_back(first + i - 1);
+                }
+            }
+
+            std::vector<std::unique_ptr<Record[]>>  m_chunks;
+            std::vector<SPuint32>                   m_free;
+    };
+
     Drawable::Drawable() :
-        m_drawable_states   {}
+        m_drawable_states   {nullptr},
+        m_handle            {}
     {
-        m_drawable_states = std::shared_ptr<DrawableStates>(new DrawableStates);
+        StatesPool& pool = StatesPool::instance();
+        m_handle            = pool.create();
+        m_drawable_states   = pool.get(m_handle);
         m_drawable_states->client   = this;
         m_drawable_states->id       = genUniqueID();
         //printf("id: %d\n", id);
     }
 
+    Drawable::Drawable(const Drawable& other) :
+        m_drawable_states   {other.m_drawable_states},
+        m_handle            {other.m_handle},
+        m_vertices          {other.m_vertices},
+        m_indices           {other.m_indices},
+        m_weld_index        {other.m_weld_index}
+    {
+        StatesPool::instance().retain(m_handle);
+    }
+
+    Drawable& Drawable::operator=(const Drawable& other)
+    {
+        if(this != &other)
+        {
+            StatesPool& pool = StatesPool::instance();
+            pool.retain(other.m_handle);
+            pool.release(m_handle);
+
+            m_drawable_states   = other.m_drawable_states;
+            m_handle            = other.m_handle;
+            m_vertices          = other.m_vertices;
+            m_indices           = other.m_indices;
+            m_weld_index        = other.m_weld_index;
+        }
+        return *this;
+    }
+
     Drawable::~Drawable()
     {
+        StatesPool::instance().release(m_handle);
+    }
+
+    Drawable::DrawableStates* Drawable::lookup(Handle handle)
+    {
+        return StatesPool::instance().get(handle);
+    }
+
+    Drawable::Handle Drawable::getHandle() const
+    {
+        return m_handle;
     }
 
     long int Drawable::getUniqueID() const
@@ -162,24 +295,7 @@ namespace sp
 
     void Drawable::add(const sp::Vertex& vertex)
     {
-        size_t len = m_vertices.size();
-        for(size_t i = 0; i < len; i++)
-        {
-            if(m_vertices[i] == vertex)
-            {
-                m_indices.push_back(static_cast<unsigned int>(i));
-                return;
-            }
-        }
-
-        vec2f pos = vertex.position;
-        m_drawable_states->bounds.left   = std::min(m_drawable_states->bounds.left  , pos.x);
-        m_drawable_states->bounds.top    = std::min(m_drawable_states->bounds.top   , pos.y);
-        m_drawable_states->bounds.width  = std::max(m_drawable_states->bounds.width , pos.x);
-        m_drawable_states->bounds.height = std::max(m_drawable_states->bounds.height, pos.y);
-
-        m_indices.push_back(static_cast<unsigned int>(m_vertices.size()));
-        m_vertices.push_back(vertex);
+        MeshBuilder(*this, true).add(vertex);
     }
 
     void Drawable::setDrawCallback(std::function<void()> fn, bool enable)
@@ -205,6 +321,20 @@ namespace sp
         m_drawable_states->states.shader = &shader;
     }
 
+    void Drawable::setUserData(const Color& data)
+    {
+        if(m_drawable_states->user_data == data)
+            return;
+
+        m_drawable_states->user_data = data;
+        m_drawable_states->update    = true;
+    }
+
+    const Color& Drawable::getUserData() const
+    {
+        return m_drawable_states->user_data;
+    }
+
     void Drawable::setPosition(const vec2f& pos)
     {
         setPosition(pos.x, pos.y);
@@ -212,18 +342,19 @@ namespace sp
 
     void Drawable::addDrawable(Renderer& renderer, bool max)
     {
-        renderer.addDrawable(m_drawable_states, max);
+        renderer.addDrawable(m_handle, max);
     }
 
     void Drawable::removeDrawable(Renderer& renderer)
     {
-        renderer.removeDrawable(m_drawable_states);
+        renderer.removeDrawable(m_handle);
     }
     void Drawable::setPosition(float x, float y)
     {
+        //the renderer only needs the new translation, not the vertices..
         m_drawable_states->position.x = x;
         m_drawable_states->position.y = y;
-        m_drawable_states->update = true;
+        m_drawable_states->moved = true;
     }
 
     const vec2f& Drawable::getPosition() const
@@ -277,6 +408,7 @@ namespace sp
     {
         m_vertices.clear();
         m_indices.clear();
+        m_weld_index.clear();
 
         m_drawable_states->bounds.left   =
         m_drawable_states->bounds.top    =
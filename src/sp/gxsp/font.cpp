@@ -1,12 +1,14 @@
 #include <sp/gxsp/font.h>
 #include <sp/exception.h>
 #include <sp/gxsp/texture.h>
+#include <sp/gxsp/shader.h>
 #include <sp/utils/helpers.h>
 #include <sp/math/math.h>
 #include <sp/spgl.h>
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include <stb/stb_truetype.h>
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
@@ -22,12 +24,107 @@ namespace sp
             SPuint64 code       = static_cast<SPuint64>(codepoint);
             return (charSize | code);
         }
+
+        const unsigned int latin_range = 256;
+
+        SPuint32 read_be(const SPuint8* p, int bytes)
+        {
+            SPuint32 value = 0;
+            for(int i = 0; i < bytes; ++i)
+                value = (value << 8) | p[i];
+            return value;
+        }
+
+        //stb_truetype follows the table directory blindly, so it has to lie
+        //within the data..
+        bool validFont(const SPuint8* data, size_t size)
+        {
+            if(size < 12)
+                return false;
+
+            size_t offset = 0;
+            if(!std::memcmp(data, "ttcf", 4))
+            {
+                if(size < 16)
+                    return false;
+                offset = read_be(data + 12, 4);
+            }
+
+            if(offset + 12 > size)
+                return false;
+
+            size_t tables = read_be(data + offset + 4, 2);
+            size_t directory = offset + 12;
+            if(directory + tables * 16 > size)
+                return false;
+
+            for(size_t i = 0; i < tables; ++i)
+            {
+                const SPuint8* record = data + directory + i * 16;
+                SPuint64 table_offset = read_be(record + 8, 4);
+                SPuint64 table_length = read_be(record + 12, 4);
+                if(table_offset + table_length > size)
+                    return false;
+            }
+            return true;
+        }
+
+        SPuint32 kerning_pair(int first, int second)
+        {
+            return (static_cast<SPuint32>(first) << 16) | (static_cast<SPuint32>(second) & 0xffff);
+        }
+
+        //texels of distance around each field glyph at the base size, and the
+        //field value of the glyph's edge; 0..255 spans the padding on either side..
+        const int           field_padding   = 4;
+        const unsigned char field_edge      = 128;
+        const float         field_scale     = 128.f / field_padding;
+
+        const char* field_vertex_shader = R"(
+            #version 110
+            attribute vec4 sp_UserData;
+            varying   vec4 params;
+
+            void main()
+            {
+                gl_Position    = ftransform();
+                gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;
+                gl_FrontColor  = gl_Color;
+                params         = sp_UserData;
+            }
+        )";
+
+        //params: outline thickness, glow radius, outline shade..
+        const char* field_fragment_shader = R"(
+            #version 110
+            uniform sampler2D texture;
+            varying vec4      params;
+
+            void main()
+            {
+                float distance  = texture2D(texture, gl_TexCoord[0].xy).a;
+                float width     = max(fwidth(distance) * 0.5, 0.0001);
+                float edge      = 0.5 - params.r * 0.5;
+
+                float fill      = smoothstep(0.5 - width, 0.5 + width, distance);
+                float outline   = smoothstep(edge - width, edge + width, distance);
+                float glow      = params.g > 0.0 ? smoothstep(edge - params.g * 0.5, edge, distance) * 0.5 : 0.0;
+
+                vec3 color      = mix(vec3(params.b), gl_Color.rgb, fill);
+                gl_FragColor    = vec4(color, max(outline, glow) * gl_Color.a);
+            }
+        )";
     }
 
     Font::Font() :
         m_font_info {nullptr},
         m_file_data {nullptr},
-        m_owning    {true}
+        m_owning    {true},
+        m_latin_table{nullptr},
+        m_latin_size{0},
+        m_distance_field{false},
+        m_field_size{32},
+        m_baked     {nullptr}
     {
     }
 
@@ -63,12 +160,22 @@ namespace sp
     {
         size_t filesize;
         SPuint8* file = spHelperFileData(filename, &filesize);
-        if(!file || !loadFromMemory(file))
+        if(!file || !loadFromMemory(file, filesize))
             return false;
         m_owning = true;
         return true;
     }
 
+    bool Font::loadFromMemory(const void* data, size_t size)
+    {
+        if(!data || !validFont(static_cast<const SPuint8*>(data), size))
+        {
+            SP_PRINT_WARNING("font data of " << size << " bytes is truncated or corrupted");
+            return false;
+        }
+        return loadFromMemory(data);
+    }
+
     bool Font::loadFromMemory(const void* data)
     {
         m_owning = false;
@@ -77,9 +184,58 @@ namespace sp
         stbtt_fontinfo* font = (stbtt_fontinfo*) calloc(1, sizeof(stbtt_fontinfo));
         stbtt_InitFont(font, static_cast<SPuint8*>(m_file_data), 0);
         m_font_info = font;
+
+        m_latin.clear();
+        m_char_map.clear();
+        m_latin_table = nullptr;
+        m_latin_size  = 0;
+        loadKerning();
         return true;
     }
 
+    void Font::loadKerning()
+    {
+        stbtt_fontinfo* font = static_cast<stbtt_fontinfo*>(m_font_info);
+
+        m_glyph_indices.resize(latin_range);
+        for(unsigned int codepoint = 0; codepoint < latin_range; ++codepoint)
+            m_glyph_indices[codepoint] = stbtt_FindGlyphIndex(font, codepoint);
+        m_glyph_index_map.clear();
+
+        //only the legacy 'kern' table can be read up front. stb_truetype
+        //prefers GPOS where both exist, so such fonts are looked up on demand
+        //and cached instead..
+        m_kerning.clear();
+        m_kerning_cache.clear();
+        int length = font->gpos ? 0 : stbtt_GetKerningTableLength(font);
+        if(length > 0)
+        {
+            std::vector<stbtt_kerningentry> table(length);
+            length = stbtt_GetKerningTable(font, table.data(), length);
+            m_kerning.reserve(length);
+            for(int i = 0; i < length; ++i)
+            {
+                m_kerning.push_back(std::make_pair(kerning_pair(table[i].glyph1, table[i].glyph2),
+                                                   static_cast<short>(table[i].advance)));
+            }
+            std::sort(m_kerning.begin(), m_kerning.end());
+        }
+    }
+
+    int Font::getGlyphIndex(unsigned int codepoint)
+    {
+        if(codepoint < latin_range)
+            return m_glyph_indices[codepoint];
+
+        auto it = m_glyph_index_map.find(codepoint);
+        if(it != m_glyph_index_map.end())
+            return it->second;
+
+        int index = stbtt_FindGlyphIndex(static_cast<stbtt_fontinfo*>(m_font_info), codepoint);
+        m_glyph_index_map.insert(std::make_pair(codepoint, index));
+        return index;
+    }
+
     const SP_Font_Map& Font::getMap(unsigned int charSize)
     {
         auto it = m_maps.find(charSize);
@@ -88,38 +244,10 @@ namespace sp
         return it->second;
     }
 
-    int nextP2(unsigned int charSize)
-    {
-        int nsize = 1;
-        while(nsize < (charSize * 10))
-            nsize = nsize << 1;
-
-        return std::min(nsize, 1024);
-    }
-
     SP_Font_Map& Font::createFontMap(unsigned int charSize)
     {
-        charSize = clamp(charSize, 0x5u, 0x64u);
-        int nsize = nextP2(charSize);
-
         SP_Font_Map& map = m_maps.insert({charSize, {}}).first->second;
-        SPuint8 tmpBitmap[nsize * nsize];
-        memset(tmpBitmap, 0, nsize * nsize);
-        stbtt_BakeFontBitmap(
-            static_cast<SPuint8*>(m_file_data),
-            0,
-            static_cast<float>(charSize),
-            tmpBitmap,
-            nsize,
-            nsize,
-            32,
-            255,
-            reinterpret_cast<stbtt_bakedchar*>(map.char_data));
-
         map.scale = stbtt_ScaleForPixelHeight(static_cast<stbtt_fontinfo*>(m_font_info), static_cast<float>(charSize));
-        map.texture.create(nsize, nsize, GL_ALPHA, GL_ALPHA);
-        map.texture.update(tmpBitmap);
-        map.texture.generateMipmap();
 
         stbtt_GetScaledFontVMetrics
         (
@@ -132,55 +260,248 @@ namespace sp
         );
 
         map.linespacing = (map.ascent - map.descent + map.linegap) * map.scale;
-        map.size = {nsize, nsize};
         return map;
     }
 
     int Font::getKerning(unsigned int first, unsigned int second)
     {
-        int glyph1 = stbtt_FindGlyphIndex(static_cast<stbtt_fontinfo*>(m_font_info), first);
-        int glyph2 = stbtt_FindGlyphIndex(static_cast<stbtt_fontinfo*>(m_font_info), second);
-        int kerning;
+        if(first == L'j') return +123;
+        else if(second == L'j') return -123;
 
-        if(first == L'j') kerning = +123;
-        else if(second == L'j')kerning = -123;
-        else kerning = stbtt_GetGlyphKernAdvance(static_cast<stbtt_fontinfo*>(m_font_info), glyph1, glyph2);
+        if(!m_font_info)
+            return 0;
+
+        SPuint32 pair = kerning_pair(getGlyphIndex(first), getGlyphIndex(second));
+        if(!m_kerning.empty())
+        {
+            auto it = std::lower_bound(m_kerning.begin(), m_kerning.end(), std::make_pair(pair, std::numeric_limits<short>::min()));
+            return (it != m_kerning.end() && it->first == pair) ? it->second : 0;
+        }
+
+        auto it = m_kerning_cache.find(pair);
+        if(it != m_kerning_cache.end())
+            return it->second;
 
+        int kerning = stbtt_GetGlyphKernAdvance(static_cast<stbtt_fontinfo*>(m_font_info), pair >> 16, pair & 0xffff);
+        m_kerning_cache.insert(std::make_pair(pair, static_cast<short>(kerning)));
         return kerning;
     }
 
     SP_Character Font::createCharacter(unsigned int codepoint, unsigned int charSize)
     {
         SP_Character character;
-        if(codepoint >= 32 && codepoint < 256)
+        character.codepoint  = codepoint;
+        character.advance    = 0.f;
+        character.bearing    = {0.f, 0.f};
+        character.size       = {0, 0};
+        character.bounds     = rectf{0.f, 0.f, 0.f, 0.f};
+        character.tex_coords = rectf{0.f, 0.f, 0.f, 0.f};
+        character.page       = 0;
+        character.glyph      = -1;
+
+        if(codepoint < 32 || !m_font_info)
+            return character;
+
+        const SP_Baked_Glyph* baked = findBaked(codepoint, charSize);
+        if(baked)
         {
-            character.codepoint = codepoint;
-            const SP_Font_Map& map = getMap(charSize);
+            character.size      = {baked->x1 - baked->x0, baked->y1 - baked->y0};
+            character.advance   = baked->advance;
+            character.bounds    = rectf{0.f, static_cast<float>(baked->y0), static_cast<float>(baked->x1 - baked->x0), static_cast<float>(baked->y1)};
+            character.bearing   = {static_cast<float>(baked->lsb), character.bounds.top};
+            return character;
+        }
+
+        const SP_Font_Map& map = getMap(charSize);
+        stbtt_fontinfo* font = static_cast<stbtt_fontinfo*>(m_font_info);
+
+        int glyph = getGlyphIndex(codepoint);
+        int advance, lsb;
+        int x0, y0, x1, y1;
+        stbtt_GetGlyphHMetrics(font, glyph, &advance, &lsb);
+        stbtt_GetGlyphBitmapBox(font, glyph, map.scale, map.scale, &x0, &y0, &x1, &y1);
+
+        //bounds are left, top, right, bottom relative to the pen on the baseline,
+        //horizontally relative to where the glyph's ink starts..
+        character.size          = {x1 - x0, y1 - y0};
+        character.advance       = static_cast<float>(advance) * map.scale;
+        character.bounds        = rectf{0.f, static_cast<float>(y0), static_cast<float>(x1 - x0), static_cast<float>(y1)};
+        character.bearing       = {static_cast<float>(lsb), character.bounds.top};
+        return character;
+    }
+
+    bool Font::getGlyph(unsigned int codepoint, unsigned int charSize, unsigned int page, SP_Character& character)
+    {
+        character = getCharInfo(codepoint, charSize);
+        character.page = page;
 
-            float x;
-            float y;
+        //whitespace has nothing to rasterize..
+        if(character.size.x <= 0 || character.size.y <= 0)
+            return true;
 
-            stbtt_fontinfo* font = static_cast<stbtt_fontinfo*>(m_font_info);
-            stbtt_aligned_quad quad;
-            stbtt_GetBakedQuad(reinterpret_cast<stbtt_bakedchar*>(const_cast<SP_Font_Map&>(map).char_data), map.size.x, map.size.y, codepoint - 32, &x, &y, &quad, 1);
-            int advance, lsb;
+        stbtt_fontinfo* font = static_cast<stbtt_fontinfo*>(m_font_info);
+        if(m_distance_field)
+        {
+            //one field glyph serves every size, only the quad is scaled..
+            const SP_Font_Map& base = getMap(m_field_size);
             int x0, y0, x1, y1;
-            stbtt_GetCodepointHMetrics(font, codepoint, &advance, &lsb);
+            stbtt_GetCodepointBitmapBox(font, codepoint, base.scale, base.scale, &x0, &y0, &x1, &y1);
 
-            stbtt_GetCodepointBitmapBox(font, codepoint, map.scale, map.scale, &x0, &y0, &x1, &y1);
-            character.size = {x1 - x0, y1 - y0};
-            character.advance = static_cast<float>(advance) * map.scale;
+            float ratio     = static_cast<float>(charSize) / static_cast<float>(m_field_size);
+            float padding   = field_padding * ratio;
+            character.bounds    = rectf{-padding, (y0 - field_padding) * ratio, (x1 - x0) * ratio + padding, (y1 + field_padding) * ratio};
+            character.bearing.y = character.bounds.top;
+        }
+
+        SPuint64 cipher = createCipher(codepoint, m_distance_field ? 0 : charSize);
+        int glyph = m_atlas.find(cipher, page);
+        if(glyph == -1 && m_distance_field)
+        {
+            int width  = 0;
+            int height = 0;
+            int xoff   = 0;
+            int yoff   = 0;
+            unsigned char* field = stbtt_GetCodepointSDF(font, getMap(m_field_size).scale, codepoint, field_padding,
+                                                         field_edge, field_scale, &width, &height, &xoff, &yoff);
+            if(!field)
+                return true;
 
-            character.bounds        = rectf{quad.x0, quad.y0, quad.x1, quad.y1};
-            character.tex_coords    = rectf{quad.s0, quad.t0, quad.s1, quad.t1};
-            character.bearing       = {static_cast<float>(lsb), character.bounds.top};
+            glyph = m_atlas.insert(cipher, page, width, height, field);
+            stbtt_FreeSDF(field, NULL);
+            if(glyph == -1)
+                return false;
         }
+        else if(glyph == -1)
+        {
+            const SP_Baked_Glyph* baked = findBaked(codepoint, charSize);
+            const SPuint8* pixels = baked ? m_baked->pixels + baked->offset : nullptr;
+            if(!pixels)
+            {
+                const SP_Font_Map& map = getMap(charSize);
+                m_raster.assign(static_cast<size_t>(character.size.x) * character.size.y, 0);
+                stbtt_MakeCodepointBitmap(font, m_raster.data(),
+                                          character.size.x, character.size.y, character.size.x,
+                                          map.scale, map.scale, codepoint);
+                pixels = m_raster.data();
+            }
 
-        return character;
+            glyph = m_atlas.insert(cipher, page, character.size.x, character.size.y, pixels);
+            if(glyph == -1)
+                return false;
+        }
+
+        character.glyph         = glyph;
+        character.tex_coords    = m_atlas.getTexCoords(glyph);
+        return true;
+    }
+
+    void Font::setBakedGlyphs(const SP_Baked_Font* baked)
+    {
+        m_baked = baked;
+        m_latin.clear();
+        m_char_map.clear();
+        m_latin_table = nullptr;
+        m_latin_size  = 0;
+    }
+
+    const SP_Baked_Glyph* Font::findBaked(unsigned int codepoint, unsigned int charSize) const
+    {
+        if(!m_baked)
+            return nullptr;
+
+        for(unsigned int i = 0; i < m_baked->count; ++i)
+        {
+            const SP_Baked_Size& size = m_baked->sizes[i];
+            if(size.char_size == charSize && codepoint >= size.first && codepoint - size.first < size.count)
+                return &size.glyphs[codepoint - size.first];
+        }
+        return nullptr;
+    }
+
+    void Font::acquireGlyph(int glyph)
+    {
+        m_atlas.acquire(glyph);
+    }
+
+    void Font::releaseGlyph(int glyph)
+    {
+        m_atlas.release(glyph);
+    }
+
+    const sp::Texture* Font::getPageTexture(unsigned int page) const
+    {
+        return m_atlas.getTexture(page);
+    }
+
+    unsigned int Font::getMaxPages() const
+    {
+        return m_atlas.getMaxPages();
+    }
+
+    SPuint64 Font::getAtlasGeneration() const
+    {
+        return m_atlas.getGeneration();
+    }
+
+    void Font::setDistanceField(bool enable, unsigned int base_size)
+    {
+        base_size = std::max(base_size, 8u);
+        if(m_distance_field == enable && m_field_size == base_size)
+            return;
+
+        m_distance_field = enable;
+        m_field_size     = base_size;
+        m_atlas.clear();
+    }
+
+    bool Font::isDistanceField() const
+    {
+        return m_distance_field;
+    }
+
+    const Shader* Font::getDistanceFieldShader()
+    {
+        //shared by all fonts, released along with the context..
+        static Shader* shader = nullptr;
+        static bool    failed = false;
+        if(!shader && !failed)
+        {
+            shader = new Shader;
+            if(!shader->loadFromMemory(field_vertex_shader, field_fragment_shader))
+            {
+                SP_PRINT_WARNING("failed to build the distance field shader");
+                delete shader;
+                shader = nullptr;
+                failed = true;
+            }
+        }
+        return shader;
+    }
+
+    const SP_Character* Font::getLatinTable(unsigned int size)
+    {
+        //labels lay out with one size, so the last table is kept at hand..
+        if(m_latin_table && m_latin_size == size)
+            return m_latin_table;
+
+        std::vector<SP_Character>& table = m_latin[size];
+        if(table.empty())
+        {
+            table.reserve(latin_range);
+            for(unsigned int codepoint = 0; codepoint < latin_range; ++codepoint)
+                table.push_back(createCharacter(codepoint, size));
+        }
+
+        m_latin_table = table.data();
+        m_latin_size  = size;
+        return m_latin_table;
     }
 
     const SP_Character& Font::getCharInfo(unsigned int codepoint, unsigned int size)
     {
+        if(codepoint < latin_range)
+            return getLatinTable(size)[codepoint];
+
         SPuint64 cipher = createCipher(codepoint, size);
         auto it = m_char_map.find(cipher);
 
@@ -190,11 +511,5 @@ namespace sp
         }
         return m_char_map.insert({cipher, createCharacter(codepoint, size)}).first->second;
     }
-
-    const sp::Texture& Font::getTexture(unsigned charSize) const
-    {
-        const sp::Texture& texture = m_maps[charSize].texture;
-        return texture;
-    }
 }
 
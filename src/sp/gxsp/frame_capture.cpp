@@ -0,0 +1,329 @@
+#include <sp/gxsp/frame_capture.h>
+#include <sp/gxsp/framebuffer.h>
+#include <sp/sp_controller.h>
+#include <sp/spgl.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <cstring>
+#include <cstdio>
+
+#define STB_IMAGE_WRITE_STATIC
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+namespace sp
+{
+    namespace
+    {
+        bool async_readback_supported()
+        {
+            return GL_ARB_sync_supported && GL_ARB_pixel_buffer_object_supported;
+        }
+    }
+
+    struct FrameCapture::Slot
+    {
+        GLuint                          pbo     = 0;
+        GLsync                          fence   = 0;
+        size_t                          bytes   = 0;
+        unsigned int                    width   = 0;
+        unsigned int                    height  = 0;
+        SPuint64                        frame   = 0;
+        bool                            busy    = false;
+        bool                            record  = false;
+
+        std::vector<std::promise<CapturedFrame>> promises;
+    };
+
+    //encodes captured frames off the rendering thread..
+    class FrameCapture::Writer
+    {
+        public:
+            Writer(const char* pattern) :
+                m_pattern   {pattern},
+                m_quit      {false},
+                m_thread    {&Writer::run, this}
+            {
+            }
+
+           ~Writer()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_quit = true;
+                }
+                m_signal.notify_one();
+                m_thread.join();
+            }
+
+            void push(CapturedFrame&& frame)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_queue.push_back(std::move(frame));
+                }
+                m_signal.notify_one();
+            }
+
+        private:
+            void run()
+            {
+                for(;;)
+                {
+                    CapturedFrame frame;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_signal.wait(lock, [this]{ return m_quit || !m_queue.empty(); });
+
+                        //drain whatever is left before quitting..
+                        if(m_queue.empty())
+                            return;
+
+                        frame = std::move(m_queue.front());
+                        m_queue.pop_front();
+                    }
+
+                    char filename[512];
+                    std::snprintf(filename, sizeof(filename), m_pattern.c_str(), static_cast<unsigned long long>(frame.frame));
+
+                    //gl rows are bottom-up, a negative stride flips them while encoding..
+                    const int stride = static_cast<int>(frame.width) * 4;
+                    const SPuint8* last_row = frame.pixels.data() + static_cast<size_t>(stride) * (frame.height - 1);
+                    if(!stbi_write_png(filename, frame.width, frame.height, 4, last_row, -stride))
+                    {
+                        SP_PRINT_WARNING("failed to write frame " << filename);
+                    }
+                }
+            }
+
+            std::string                 m_pattern;
+            std::deque<CapturedFrame>   m_queue;
+            std::mutex                  m_mutex;
+            std::condition_variable     m_signal;
+            bool                        m_quit;
+            std::thread                 m_thread;
+    };
+
+    FrameCapture::FrameCapture(unsigned int depth) :
+        m_slots     (depth ? depth : 1),
+        m_head      {0},
+        m_pending   {0},
+        m_frame     {0}
+    {
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        //frames still in flight are resolved, so no future is left dangling..
+        if(Controller::active())
+        {
+            poll(true);
+            release();
+        }
+        m_writer.reset();
+    }
+
+    std::future<CapturedFrame> FrameCapture::request()
+    {
+        m_requests.emplace_back();
+        return m_requests.back().get_future();
+    }
+
+    std::future<CapturedFrame> FrameCapture::request(const Framebuffer& framebuffer)
+    {
+        Slot* slot = acquire();
+        slot->promises.emplace_back();
+        std::future<CapturedFrame> future = slot->promises.back().get_future();
+        readback(framebuffer, *slot);
+        return future;
+    }
+
+    bool FrameCapture::record(const char* pattern)
+    {
+        if(!pattern || !*pattern)
+        {
+            SP_PRINT_WARNING("cannot record frames without a filename pattern");
+            return false;
+        }
+
+        m_writer.reset(new Writer(pattern));
+        return true;
+    }
+
+    void FrameCapture::stop()
+    {
+        poll(true);
+        m_writer.reset();
+    }
+
+    bool FrameCapture::isRecording() const
+    {
+        return m_writer != nullptr;
+    }
+
+    size_t FrameCapture::pending() const
+    {
+        return m_pending;
+    }
+
+    void FrameCapture::update(const Framebuffer& framebuffer)
+    {
+        m_frame++;
+        poll(false);
+
+        if(m_requests.empty() && !m_writer)
+            return;
+
+        //a single readback serves every request made since the last frame..
+        Slot* slot = acquire();
+        slot->record = m_writer != nullptr;
+        slot->promises.swap(m_requests);
+        readback(framebuffer, *slot);
+    }
+
+    void FrameCapture::poll(bool wait)
+    {
+        //slots are resolved in submission order, starting at the oldest one..
+        for(size_t i = 0; i < m_slots.size() && m_pending; ++i)
+        {
+            Slot& slot = m_slots[(m_head + i) % m_slots.size()];
+            if(!slot.busy)
+                continue;
+
+            GLenum result = GL_ALREADY_SIGNALED;
+            spCheck(result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0))
+            if(result == GL_TIMEOUT_EXPIRED)
+                break;
+
+            resolve(slot);
+        }
+    }
+
+    FrameCapture::Slot* FrameCapture::acquire()
+    {
+        Slot* slot = &m_slots[m_head];
+        if(slot->busy)
+        {
+            //the ring is exhausted, the gpu is more than a ring behind..
+            spCheck(glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED))
+            resolve(*slot);
+        }
+
+        m_head = (m_head + 1) % m_slots.size();
+        slot->record = false;
+        slot->promises.clear();
+        return slot;
+    }
+
+    void FrameCapture::readback(const Framebuffer& framebuffer, Slot& slot)
+    {
+        slot.width  = framebuffer.m_size.x;
+        slot.height = framebuffer.m_size.y;
+        slot.frame  = m_frame;
+        slot.bytes  = static_cast<size_t>(slot.width) * slot.height * 4;
+
+        GLint read_fbo = 0;
+        spCheck(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING_EXT, &read_fbo))
+        spCheck(glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, framebuffer.m_fbo_obj))
+        spCheck(glReadBuffer(GL_COLOR_ATTACHMENT0_EXT + 2))
+        spCheck(glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT))
+        spCheck(glPixelStorei(GL_PACK_ALIGNMENT, 4))
+
+        if(async_readback_supported())
+        {
+            if(!slot.pbo)
+            {
+                spCheck(glGenBuffersARB(1, &slot.pbo))
+            }
+
+            spCheck(glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, slot.pbo))
+            spCheck(glBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, slot.bytes, NULL, GL_STREAM_READ_ARB))
+            spCheck(glReadPixels(0, 0, slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE, NULL))
+            spCheck(glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0))
+            spCheck(slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0))
+
+            slot.busy = true;
+            m_pending++;
+        }
+        else
+        {
+            //no pbos or fences, the readback stalls..
+            CapturedFrame frame;
+            frame.width  = slot.width;
+            frame.height = slot.height;
+            frame.frame  = slot.frame;
+            frame.pixels.resize(slot.bytes);
+            spCheck(glReadPixels(0, 0, slot.width, slot.height, GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels.data()))
+            deliver(slot, std::move(frame));
+        }
+
+        spCheck(glPopClientAttrib())
+        spCheck(glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, read_fbo))
+    }
+
+    void FrameCapture::resolve(Slot& slot)
+    {
+        CapturedFrame frame;
+        frame.width  = slot.width;
+        frame.height = slot.height;
+        frame.frame  = slot.frame;
+        frame.pixels.resize(slot.bytes);
+
+        spCheck(glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, slot.pbo))
+        const void* data = NULL;
+        spCheck(data = glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB))
+        if(data)
+        {
+            std::memcpy(frame.pixels.data(), data, slot.bytes);
+            spCheck(glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB))
+        }
+        else
+        {
+            SP_PRINT_WARNING("failed to map pixel pack buffer");
+        }
+        spCheck(glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0))
+        spCheck(glDeleteSync(slot.fence))
+
+        slot.fence = 0;
+        slot.busy  = false;
+        m_pending--;
+
+        deliver(slot, std::move(frame));
+    }
+
+    //hands the pixels to every consumer, the last one takes ownership..
+    void FrameCapture::deliver(Slot& slot, CapturedFrame&& frame)
+    {
+        for(size_t i = 0; i < slot.promises.size(); ++i)
+        {
+            bool last = (i + 1 == slot.promises.size()) && !(slot.record && m_writer);
+            slot.promises[i].set_value(last ? std::move(frame) : frame);
+        }
+
+        if(slot.record && m_writer)
+            m_writer->push(std::move(frame));
+
+        slot.promises.clear();
+        slot.record = false;
+    }
+
+    void FrameCapture::release()
+    {
+        for(auto& slot : m_slots)
+        {
+            if(slot.fence)
+            {
+                spCheck(glDeleteSync(slot.fence))
+                slot.fence = 0;
+            }
+
+            if(slot.pbo)
+            {
+                spCheck(glDeleteBuffersARB(1, &slot.pbo))
+                slot.pbo = 0;
+            }
+        }
+    }
+}
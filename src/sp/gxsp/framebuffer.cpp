@@ -79,7 +79,10 @@ namespace sp
         m_color_buffer          {nullptr},
         m_samples               {0},
         m_texture               {0},
-        m_size                  {0, 0}
+        m_size                  {0, 0},
+        m_batch_texture         {nullptr},
+        m_batch_blending        {BlendAlpha},
+        m_batching              {false}
     {
     }
 
@@ -293,8 +296,10 @@ namespace sp
         static Transformable trm;
         trm.setPosition(offset);
         trm.setScale(scale);
+        float matrix[16];
+        trm.getTransform().toGL(matrix);
         spCheck(glMatrixMode(GL_MODELVIEW))
-        spCheck(glLoadMatrixf(trm.getMatrix()()))
+        spCheck(glLoadMatrixf(matrix))
 
 
         if(primitive_type == GL_POINTS)
@@ -346,6 +351,126 @@ namespace sp
 		spCheck(glPopAttrib())
     }
 
+    void Framebuffer::begin()
+    {
+        if(m_batching)
+        {
+            SP_PRINT_WARNING("framebuffer batch already begun");
+            return;
+        }
+
+        spCheck(glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT | GL_CLIENT_VERTEX_ARRAY_BIT))
+        spCheck(glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT))
+
+        if(GL_ARB_multitexture_supported)
+        {
+            spCheck(glClientActiveTextureARB(GL_TEXTURE0_ARB))
+            spCheck(glActiveTextureARB(GL_TEXTURE0_ARB))
+        }
+
+        spCheck(glPointSize(1.f));
+        spCheck(glDisable(GL_CULL_FACE))
+        spCheck(glDisable(GL_LIGHTING))
+        spCheck(glDisable(GL_DEPTH_TEST))
+        spCheck(glDisable(GL_ALPHA_TEST))
+        spCheck(glEnable(GL_TEXTURE_2D))
+        spCheck(glEnable(GL_BLEND))
+        spCheck(glEnable(GL_SCISSOR_TEST))
+        spCheck(glMatrixMode(GL_MODELVIEW))
+        spCheck(glPushMatrix())
+        spCheck(glLoadIdentity())
+        spCheck(glEnableClientState(GL_VERTEX_ARRAY))
+        spCheck(glEnableClientState(GL_COLOR_ARRAY))
+        spCheck(glEnableClientState(GL_TEXTURE_COORD_ARRAY))
+        sp::Shader::bind(NULL);
+
+        static Viewport viewport;
+        viewport.setViewport(sp::rectf{0.f, 0.f, static_cast<float>(m_size.x), static_cast<float>(m_size.y)});
+        viewport.load();
+
+        m_batch_vertices.clear();
+        m_batch_indices.clear();
+        m_batch_texture  = nullptr;
+        m_batch_blending = BlendAlpha;
+        m_batching       = true;
+    }
+
+    void Framebuffer::submit(const Vertex* quads, size_t quad_count, const sp::Texture* texture, const vec2f& offset, Blending blending)
+    {
+        if(!m_batching)
+        {
+            SP_PRINT_WARNING("framebuffer submit outside of begin/end");
+            return;
+        }
+
+        if(!quads || !quad_count)
+            return;
+
+        //pending quads of other states go first, so the order is kept..
+        if(!m_batch_vertices.empty() && (texture != m_batch_texture || blending != m_batch_blending))
+            flushBatch();
+
+        //bounds the buffer for huge bakes, a flush per this many quads is cheap..
+        const size_t max_quads = 16384;
+        if(m_batch_vertices.size() / 4 + quad_count > max_quads)
+            flushBatch();
+
+        m_batch_texture  = texture;
+        m_batch_blending = blending;
+
+        m_batch_vertices.reserve(m_batch_vertices.size() + quad_count * 4);
+        m_batch_indices.reserve(m_batch_indices.size() + quad_count * 6);
+        for(size_t q = 0; q < quad_count; ++q)
+        {
+            unsigned int base = static_cast<unsigned int>(m_batch_vertices.size());
+            for(size_t v = 0; v < 4; ++v)
+            {
+                Vertex vertex = quads[q * 4 + v];
+                vertex.position += offset;
+                m_batch_vertices.push_back(vertex);
+            }
+
+            const unsigned int quad_indices[6] = {0, 1, 2, 2, 1, 3};
+            for(unsigned int index : quad_indices)
+                m_batch_indices.push_back(base + index);
+        }
+    }
+
+    void Framebuffer::flushBatch()
+    {
+        if(m_batch_indices.empty())
+            return;
+
+        applyBlending(m_batch_blending);
+        sp::Texture::bind(m_batch_texture, sp::Texture::SP_Mapping::Pixels);
+
+        const char* data = reinterpret_cast<const char*>(m_batch_vertices.data());
+        spCheck(glVertexPointer(2, GL_FLOAT, sizeof(Vertex), data));
+        spCheck(glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), data + 8))
+        spCheck(glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), data + 12))
+        spCheck(glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_batch_indices.size()), GL_UNSIGNED_INT, m_batch_indices.data()))
+
+        m_batch_vertices.clear();
+        m_batch_indices.clear();
+    }
+
+    void Framebuffer::end()
+    {
+        if(!m_batching)
+            return;
+
+        flushBatch();
+        m_batching = false;
+
+        spCheck(glMatrixMode(GL_MODELVIEW))
+        spCheck(glPopMatrix())
+
+        sp::Texture::bind(NULL);
+
+        spCheck(glPopClientAttrib())
+        spCheck(glPopAttrib())
+    }
+
     //display(int texture);
 
     /*
@@ -0,0 +1,309 @@
+#include <sp/gxsp/glyph_atlas.h>
+#include <sp/spgl.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace sp
+{
+    namespace
+    {
+        //keeps bilinear filtering from bleeding into neighbours..
+        const unsigned int glyph_padding = 1;
+
+        //shelves are rounded up so that similar glyph heights share them..
+        const unsigned int shelf_granularity = 4;
+
+        SPuint64 lookup_key(SPuint64 key, unsigned int page)
+        {
+            return (key << 8) | (page & 0xff);
+        }
+    }
+
+    GlyphAtlas::GlyphAtlas(unsigned int page_size, unsigned int max_pages) :
+        m_page_size {page_size},
+        m_max_pages {std::max(1u, std::min(max_pages, 256u))},
+        m_clock     {0},
+        m_generation{0}
+    {
+    }
+
+    GlyphAtlas::~GlyphAtlas()
+    {
+    }
+
+    int GlyphAtlas::find(SPuint64 key, unsigned int page)
+    {
+        auto it = m_lookup.find(lookup_key(key, page));
+        if(it == m_lookup.end())
+            return -1;
+
+        m_slots[it->second].glyph.last_use = ++m_clock;
+        return it->second;
+    }
+
+    int GlyphAtlas::insert(SPuint64 key, unsigned int page, unsigned int width, unsigned int height, const SPuint8* pixels)
+    {
+        if(page >= m_max_pages)
+            return -1;
+
+        int id = find(key, page);
+        if(id != -1)
+            return id;
+
+        unsigned int padded_width  = width  + 2 * glyph_padding;
+        unsigned int padded_height = height + 2 * glyph_padding;
+        if(padded_width > m_page_size || padded_height > m_page_size)
+        {
+            SP_PRINT_WARNING("glyph of " << width << "x" << height << " exceeds the atlas page size");
+            return -1;
+        }
+
+        while(page >= m_pages.size())
+        {
+            if(!createPage())
+                return -1;
+        }
+
+        id = reuse(page, padded_width, padded_height);
+        if(id == -1)
+        {
+            recti rect;
+            if(allocate(m_pages[page], padded_width, padded_height, rect))
+            {
+                Slot slot;
+                slot.rect = rect;
+                slot.used = false;
+                id = static_cast<int>(m_slots.size());
+                m_slots.push_back(slot);
+            }
+        }
+
+        if(id == -1)
+            id = evict(page, padded_width, padded_height);
+
+        if(id == -1)
+            return -1;
+
+        Slot& slot = m_slots[id];
+        slot.used           = true;
+        slot.glyph.key      = key;
+        slot.glyph.page     = page;
+        slot.glyph.area     = recti{slot.rect.left + static_cast<int>(glyph_padding), slot.rect.top + static_cast<int>(glyph_padding),
+                                    static_cast<int>(width), static_cast<int>(height)};
+        slot.glyph.last_use = ++m_clock;
+        slot.glyph.refs     = 0;
+
+        upload(slot, pixels);
+        m_lookup[lookup_key(key, page)] = id;
+        return id;
+    }
+
+    void GlyphAtlas::acquire(int id)
+    {
+        if(id >= 0 && static_cast<size_t>(id) < m_slots.size() && m_slots[id].used)
+            ++m_slots[id].glyph.refs;
+    }
+
+    void GlyphAtlas::release(int id)
+    {
+        if(id >= 0 && static_cast<size_t>(id) < m_slots.size() && m_slots[id].glyph.refs)
+            --m_slots[id].glyph.refs;
+    }
+
+    const GlyphAtlas::Glyph& GlyphAtlas::getGlyph(int id) const
+    {
+        return m_slots[id].glyph;
+    }
+
+    rectf GlyphAtlas::getTexCoords(int id) const
+    {
+        const recti& area = m_slots[id].glyph.area;
+        float size = static_cast<float>(m_page_size);
+
+        //left, top, right, bottom - as the baked quads used to be..
+        return rectf
+        {
+            area.left / size,
+            area.top  / size,
+            (area.left + area.width)  / size,
+            (area.top  + area.height) / size
+        };
+    }
+
+    const Texture* GlyphAtlas::getTexture(unsigned int page) const
+    {
+        return page < m_pages.size() ? m_pages[page].texture.get() : nullptr;
+    }
+
+    unsigned int GlyphAtlas::getPageCount() const
+    {
+        return static_cast<unsigned int>(m_pages.size());
+    }
+
+    unsigned int GlyphAtlas::getMaxPages() const
+    {
+        return m_max_pages;
+    }
+
+    unsigned int GlyphAtlas::getPageSize() const
+    {
+        return m_page_size;
+    }
+
+    SPuint64 GlyphAtlas::getGeneration() const
+    {
+        return m_generation;
+    }
+
+    void GlyphAtlas::clear()
+    {
+        m_pages.clear();
+        m_slots.clear();
+        m_lookup.clear();
+        m_clock = 0;
+        ++m_generation;
+    }
+
+    bool GlyphAtlas::createPage()
+    {
+        if(m_pages.size() >= m_max_pages)
+            return false;
+
+        Page page;
+        page.texture.reset(new Texture);
+        page.bottom = 0;
+
+        GLint bound = 0;
+        spCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound))
+
+        bool status = page.texture->create(m_page_size, m_page_size, GL_ALPHA, GL_ALPHA);
+        if(status)
+        {
+            page.texture->setSmooth(true);
+
+            //the storage of a fresh texture is undefined..
+            std::vector<SPuint8> blank(static_cast<size_t>(m_page_size) * m_page_size, 0);
+            spCheck(glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT))
+            spCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, 1))
+            page.texture->update(blank.data());
+            spCheck(glPopClientAttrib())
+        }
+        spCheck(glBindTexture(GL_TEXTURE_2D, bound))
+
+        if(!status)
+        {
+            SP_PRINT_WARNING("failed to create glyph atlas page");
+            return false;
+        }
+
+        m_pages.push_back(std::move(page));
+        return true;
+    }
+
+    bool GlyphAtlas::allocate(Page& page, unsigned int width, unsigned int height, recti& rect)
+    {
+        unsigned int shelf_height = (height + shelf_granularity - 1) / shelf_granularity * shelf_granularity;
+        shelf_height = std::min(shelf_height, m_page_size);
+
+        //best fitting shelf with enough room left..
+        Shelf* best = nullptr;
+        for(Shelf& shelf : page.shelves)
+        {
+            if(shelf.height < height || shelf.height > shelf_height * 2 || shelf.cursor + width > m_page_size)
+                continue;
+            if(!best || shelf.height < best->height)
+                best = &shelf;
+        }
+
+        if(!best)
+        {
+            if(page.bottom + shelf_height > m_page_size)
+                return false;
+
+            Shelf shelf;
+            shelf.top       = page.bottom;
+            shelf.height    = shelf_height;
+            shelf.cursor    = 0;
+            page.bottom    += shelf_height;
+            page.shelves.push_back(shelf);
+            best = &page.shelves.back();
+        }
+
+        rect = recti{static_cast<int>(best->cursor), static_cast<int>(best->top), static_cast<int>(width), static_cast<int>(best->height)};
+        best->cursor += width;
+        return true;
+    }
+
+    int GlyphAtlas::reuse(unsigned int page, unsigned int width, unsigned int height)
+    {
+        //smallest evicted slot on the page that fits..
+        int best = -1;
+        for(size_t i = 0; i < m_slots.size(); ++i)
+        {
+            const Slot& slot = m_slots[i];
+            if(slot.used || slot.glyph.page != page)
+                continue;
+            if(slot.rect.width < static_cast<int>(width) || slot.rect.height < static_cast<int>(height))
+                continue;
+            if(best == -1 || slot.rect.width * slot.rect.height < m_slots[best].rect.width * m_slots[best].rect.height)
+                best = static_cast<int>(i);
+        }
+        return best;
+    }
+
+    int GlyphAtlas::evict(unsigned int page, unsigned int width, unsigned int height)
+    {
+        int victim = -1;
+        SPuint64 oldest = std::numeric_limits<SPuint64>::max();
+        for(size_t i = 0; i < m_slots.size(); ++i)
+        {
+            const Slot& slot = m_slots[i];
+            if(!slot.used || slot.glyph.page != page || slot.glyph.refs)
+                continue;
+            if(slot.rect.width < static_cast<int>(width) || slot.rect.height < static_cast<int>(height))
+                continue;
+            if(slot.glyph.last_use < oldest)
+            {
+                oldest = slot.glyph.last_use;
+                victim = static_cast<int>(i);
+            }
+        }
+
+        if(victim != -1)
+        {
+            Slot& slot = m_slots[victim];
+            m_lookup.erase(lookup_key(slot.glyph.key, slot.glyph.page));
+            slot.used = false;
+            ++m_generation;
+        }
+        return victim;
+    }
+
+    void GlyphAtlas::upload(const Slot& slot, const SPuint8* pixels)
+    {
+        //the whole slot is written, so remains of an evicted glyph are wiped..
+        size_t stride = static_cast<size_t>(slot.rect.width);
+        std::vector<SPuint8> data(stride * slot.rect.height, 0);
+        if(pixels)
+        {
+            for(int y = 0; y < slot.glyph.area.height; ++y)
+            {
+                std::memcpy(&data[(y + glyph_padding) * stride + glyph_padding],
+                            pixels + static_cast<size_t>(y) * slot.glyph.area.width,
+                            slot.glyph.area.width);
+            }
+        }
+
+        GLint bound = 0;
+        spCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound))
+
+        Texture& texture = *m_pages[slot.glyph.page].texture;
+        spCheck(glBindTexture(GL_TEXTURE_2D, texture.getHandleGL()))
+        spCheck(glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT))
+        spCheck(glPixelStorei(GL_UNPACK_ALIGNMENT, 1))
+        texture.update(data.data(), slot.rect.left, slot.rect.top, slot.rect.width, slot.rect.height);
+        spCheck(glPopClientAttrib())
+        spCheck(glBindTexture(GL_TEXTURE_2D, bound))
+    }
+}
@@ -1,8 +1,61 @@
 #include <sp/gxsp/label.h>
 #include <sp/gxsp/batch_renderer.h>
+#include <sp/gxsp/mesh_builder.h>
+#include <sp/math/math.h>
+#include <unordered_map>
 
 namespace sp
 {
+    namespace
+    {
+        //laid out runs, shared by all labels; repeated strings such as
+        //damage numbers or chat names reuse the vertices directly..
+        struct Run
+        {
+            std::weak_ptr<Font>     font;
+            unsigned int            char_size;
+            unsigned int            page;
+            SPuint64                generation;
+            SPuint64                last_use;
+            String                  text;
+            std::vector<Vertex>     vertices;
+            std::vector<int>        glyphs;
+            std::vector<size_t>     vertex_ends;
+            std::vector<float>      advances;
+        };
+
+        const size_t run_cache_capacity = 512;
+        const size_t run_max_length     = 64;
+
+        std::unordered_map<SPuint64, Run>& run_cache()
+        {
+            static std::unordered_map<SPuint64, Run> cache;
+            return cache;
+        }
+
+        SPuint64& run_clock()
+        {
+            static SPuint64 clock = 0;
+            return clock;
+        }
+
+        SPuint64 run_key(const Font* font, unsigned int char_size, const String& text)
+        {
+            SPuint64 key = 14695981039346656037ull;
+            auto mix = [&key](SPuint64 value)
+            {
+                key ^= value;
+                key *= 1099511628211ull;
+            };
+
+            mix(reinterpret_cast<SPuint64>(font));
+            mix(char_size);
+            for(size_t i = 0; i < text.length(); ++i)
+                mix(static_cast<SPuint64>(text[i]));
+            return key;
+        }
+    }
+
     Label::Label() :
         Drawable(),
         m_map               {nullptr},
@@ -15,6 +68,7 @@ namespace sp
         m_character_count   {0},
         m_previous_count    {0},
         m_traverser         {0},
+        m_page              {0},
         m_refresh           {true}
     {
         m_drawable_states->vertex_entry   = 0;
@@ -23,6 +77,7 @@ namespace sp
 
     Label::~Label()
     {
+        releaseGlyphs();
     }
 
     Label::Ptr Label::create()
@@ -32,7 +87,7 @@ namespace sp
 
     void Label::addDrawable(Renderer& renderer, bool max)
     {
-        renderer.addDrawable(m_drawable_states, max);
+        renderer.addDrawable(m_handle, max);
     }
     void Label::setCharacterSize(unsigned int charSize)
     {
@@ -40,8 +95,8 @@ namespace sp
           //  return;
 
         m_char_size         = charSize;
+        m_traverser         = 0;
         m_map               = m_font.lock() ? &m_font.lock()->getMap(m_char_size) : nullptr;
-        m_drawable_states->states.texture    = m_font.lock() ? &m_font.lock()->getTexture(m_char_size) : nullptr;
         m_refresh           = true;
         refresh();
     }
@@ -51,7 +106,14 @@ namespace sp
         if(m_string == text)
             return;
 
-        m_traverser = 0;
+        //only the characters behind the common prefix are laid out again..
+        size_t prefix = 0;
+        size_t length = std::min(m_string.length(), text.length());
+        while(prefix < length && m_string[prefix] == text[prefix])
+            ++prefix;
+
+        m_traverser = std::min(m_traverser, prefix);
+        m_previous_string = m_string;
         m_previous_count  = m_character_count;
         m_character_count = text.length();
         m_refresh = true;
@@ -70,6 +132,21 @@ namespace sp
             v.color = color;
     }
 
+    void Label::setOutline(float thickness, SPuint8 shade)
+    {
+        Color params = getUserData();
+        params.r = static_cast<SPuint8>(clamp(thickness, 0.f, 1.f) * 255.f);
+        params.b = shade;
+        setUserData(params);
+    }
+
+    void Label::setGlow(float radius)
+    {
+        Color params = getUserData();
+        params.g = static_cast<SPuint8>(clamp(radius, 0.f, 1.f) * 255.f);
+        setUserData(params);
+    }
+
     void Label::setPosition(float x, float y)
     {
         Drawable::setPosition(x, y);
@@ -84,8 +161,11 @@ namespace sp
         if(!font)
             return;
 
+        releaseGlyphs();
         m_font.reset();
         m_font = font;
+        m_page = 0;
+        m_traverser = 0;
         setCharacterSize(m_char_size);
     }
 
@@ -102,8 +182,8 @@ namespace sp
         rectf bounds =
         rectf
         {
-            offset.x, offset.y,
-            std::abs(character.bounds.width  - character.bounds.left) + offset.x,
+            character.bounds.left  + offset.x, offset.y,
+            character.bounds.width + offset.x,
             std::abs(character.bounds.height - character.bounds.top)  + offset.y,
         };
 
@@ -112,14 +192,14 @@ namespace sp
         float top    = character.tex_coords.top;
         float bottom = character.tex_coords.height;
 
-        sp::Vertex v1 = {vec2f{bounds.left,  bounds.top},  m_color, vec2f{left, top}};
-        sp::Vertex v2 = {vec2f{bounds.width, bounds.top}, m_color, vec2f{right, top}};
-        sp::Vertex v3 = {vec2f{bounds.left, bounds.height}, m_color, vec2f{left, bottom}};
-        sp::Vertex v4 = {vec2f{bounds.width, bounds.height}, m_color, vec2f{right, bottom}};
-
-        add(v1); add(v2);
-        add(v3); add(v3);
-        add(v2); add(v4);
+        //glyph corners are never shared, so nothing is welded..
+        MeshBuilder(*this).addQuad
+        (
+            Vertex{vec2f{bounds.left,  bounds.top},    m_color, vec2f{left,  top}},
+            Vertex{vec2f{bounds.width, bounds.top},    m_color, vec2f{right, top}},
+            Vertex{vec2f{bounds.left,  bounds.height}, m_color, vec2f{left,  bottom}},
+            Vertex{vec2f{bounds.width, bounds.height}, m_color, vec2f{right, bottom}}
+        );
     }
 
 
@@ -149,21 +229,30 @@ namespace sp
         sp::Vertex v3 = {vec2f{_left, _height}, m_color, vec2f{left, bottom}};
         sp::Vertex v4 = {vec2f{_width, _height}, m_color, vec2f{right, bottom}};
 
-        add(v1); add(v2);
-        add(v3); add(v3);
-        add(v2); add(v4);
+        MeshBuilder(*this).addQuad(v1, v2, v3, v4);
     }
 
     sp::vec2f Label::getSize() const
     {
         return sp::vec2f{m_drawable_states->bounds.width, m_drawable_states->bounds.height};
     }
-    void Label::createCharacter(unsigned int prev, unsigned int curr)
+    bool Label::createCharacter(unsigned int prev, unsigned int curr)
     {
         if(curr == L'\r' || curr == L'\n' || curr == L'\t')
-            return;
+        {
+            m_glyphs.push_back(-1);
+            m_vertex_ends.push_back(m_vertices.size());
+            m_advances.push_back(m_advance);
+            return true;
+        }
+
+        SP_Character character;
+        if(!m_font.lock()->getGlyph(curr, m_char_size, m_page, character))
+            return false;
+
+        if(character.glyph != -1)
+            m_font.lock()->acquireGlyph(character.glyph);
 
-        const SP_Character& character = m_font.lock()->getCharInfo(curr, m_char_size);
         float kerning = m_map->scale * m_font.lock()->getKerning(prev, curr) * 2.f;
         float ascent = m_ascent + character.bearing.y;
 
@@ -175,6 +264,117 @@ namespace sp
         }
         float distance = character.advance + kerning;
         m_advance += distance;
+
+        m_glyphs.push_back(character.glyph);
+        m_vertex_ends.push_back(m_vertices.size());
+        m_advances.push_back(m_advance);
+        return true;
+    }
+
+    void Label::releaseGlyphs(size_t first)
+    {
+        if(first >= m_glyphs.size())
+            return;
+
+        Font::Ptr font = m_font.lock();
+        if(font)
+        {
+            for(size_t i = first; i < m_glyphs.size(); ++i)
+                font->releaseGlyph(m_glyphs[i]);
+        }
+        m_glyphs.resize(first);
+        m_vertex_ends.resize(first);
+        m_advances.resize(first);
+    }
+
+    bool Label::layout(size_t first)
+    {
+        releaseGlyphs(first);
+
+        size_t vertex_count = first ? m_vertex_ends[first - 1] : 0;
+        m_vertices.resize(vertex_count);
+        m_indices.resize(vertex_count / 4 * 6);
+        m_advance = first ? m_advances[first - 1] : 0.f;
+
+        unsigned int prevChar = first ? m_string[first - 1] : 0;
+        for(size_t i = first; i < m_character_count; ++i)
+        {
+            unsigned int currentChar = m_string[i];
+            if(!createCharacter(prevChar, currentChar))
+            {
+                releaseGlyphs();
+                return false;
+            }
+            prevChar = currentChar;
+        }
+        return true;
+    }
+
+    bool Label::loadRun()
+    {
+        Font::Ptr font = m_font.lock();
+        auto& cache = run_cache();
+        auto it = cache.find(run_key(font.get(), m_char_size, m_string));
+        if(it == cache.end())
+            return false;
+
+        //glyphs may have been evicted since the run was stored..
+        Run& run = it->second;
+        if(run.font.lock() != font || run.char_size != m_char_size || run.text != m_string
+        || run.generation != font->getAtlasGeneration())
+        {
+            cache.erase(it);
+            return false;
+        }
+
+        run.last_use = ++run_clock();
+
+        releaseGlyphs();
+        m_page        = run.page;
+        m_glyphs      = run.glyphs;
+        m_vertex_ends = run.vertex_ends;
+        m_advances    = run.advances;
+        m_advance     = m_advances.empty() ? 0.f : m_advances.back();
+        for(int glyph : m_glyphs)
+            font->acquireGlyph(glyph);
+
+        m_vertices.clear();
+        m_indices.clear();
+        MeshBuilder(*this).addQuads(run.vertices.data(), run.vertices.size() / 4);
+        for(auto& v : m_vertices)
+            v.color = m_color;
+        return true;
+    }
+
+    void Label::storeRun() const
+    {
+        if(m_character_count > run_max_length)
+            return;
+
+        Font::Ptr font = m_font.lock();
+        auto& cache = run_cache();
+        if(cache.size() >= run_cache_capacity)
+        {
+            auto oldest = cache.begin();
+            for(auto it = cache.begin(); it != cache.end(); ++it)
+            {
+                if(it->second.last_use < oldest->second.last_use)
+                    oldest = it;
+            }
+            cache.erase(oldest);
+        }
+
+        Run& run = cache[run_key(font.get(), m_char_size, m_string)];
+        run.font        = font;
+        run.char_size   = m_char_size;
+        run.page        = m_page;
+        run.generation  = font->getAtlasGeneration();
+        run.last_use    = ++run_clock();
+        run.text        = m_string;
+        run.vertices    = m_vertices;
+        run.glyphs      = m_glyphs;
+        run.vertex_ends = m_vertex_ends;
+        run.advances    = m_advances;
     }
 
     void Label::refresh()
@@ -191,6 +391,15 @@ namespace sp
         }
         if(m_string.empty())
         {
+            releaseGlyphs();
+            m_vertices.clear();
+            m_indices.clear();
+            m_traverser = 0;
+            m_refresh   = false;
+            m_drawable_states->bounds       = rectf{0.f, 0.f, 0.f, 0.f};
+            m_drawable_states->vertex_count = 0;
+            m_drawable_states->index_count  = 0;
+            m_drawable_states->update       = true;
             return;
         }
 
@@ -218,24 +427,46 @@ namespace sp
 
         if(m_refresh)
         {
-            m_vertices.clear();
-            m_indices.clear();
-
             m_refresh = false;
-            unsigned int prevChar = 0;
-            m_advance = 0.f;
             m_ascent = m_font.lock()->getCharInfo(L'g', m_char_size).size.y;
             m_drawable_states->update = true;
 
-            for(size_t i = 0; i < m_character_count; ++i)
+            bool placed = !m_traverser && loadRun();
+            if(!placed)
             {
-                unsigned int currentChar = m_string[i];
-                createCharacter(prevChar, currentChar);
-                prevChar = currentChar;
+                //a label is one drawable with one texture, so all of its glyphs
+                //must share an atlas page; move on to the next page when one is full..
+                unsigned int pages = m_font.lock()->getMaxPages();
+                placed = layout(m_traverser);
+                for(unsigned int i = 1; i < pages && !placed; ++i)
+                {
+                    m_page = (m_page + 1) % pages;
+                    placed = layout(0);
+                }
+
+                if(placed)
+                    storeRun();
             }
 
-            m_drawable_states->bounds.width   = m_advance;
-            m_drawable_states->bounds.height  = m_ascent;
+            if(placed)
+            {
+                m_traverser = m_character_count;
+            }
+            else
+            {
+                SP_PRINT_WARNING("glyph atlas exhausted, label cannot be displayed");
+                m_vertices.clear();
+                m_indices.clear();
+                m_traverser = 0;
+            }
+
+            m_drawable_states->states.texture = m_font.lock()->getPageTexture(m_page);
+
+            //distance field text shares one texture and one shader across all sizes..
+            if(m_font.lock()->isDistanceField() && !m_drawable_states->states.shader)
+                m_drawable_states->states.shader = Font::getDistanceFieldShader();
+
+            m_drawable_states->bounds = rectf{0.f, 0.f, m_advance, m_ascent};
 
             m_drawable_states->vertex_count   = m_vertices.size();
             m_drawable_states->index_count    = m_indices.size();
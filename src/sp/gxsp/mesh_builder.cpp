@@ -0,0 +1,190 @@
+#include <sp/gxsp/mesh_builder.h>
+#include <sp/gxsp/drawable.h>
+#include <algorithm>
+#include <cstring>
+
+namespace sp
+{
+    namespace
+    {
+        const unsigned int quad_indices[6] = {0, 1, 2, 2, 1, 3};
+
+        SPuint32 float_bits(float value)
+        {
+            //-0 and +0 weld..
+            if(value == 0.f)
+                return 0;
+
+            SPuint32 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        SPuint64 vertex_key(const Vertex& vertex)
+        {
+            SPuint64 key = 14695981039346656037ull;
+            auto mix = [&key](SPuint32 value)
+            {
+                key ^= value;
+                key *= 1099511628211ull;
+            };
+
+            mix(float_bits(vertex.position.x));
+            mix(float_bits(vertex.position.y));
+            mix(float_bits(vertex.texCoords.x));
+            mix(float_bits(vertex.texCoords.y));
+            mix((static_cast<SPuint32>(vertex.color.r) << 24) | (static_cast<SPuint32>(vertex.color.g) << 16)
+              | (static_cast<SPuint32>(vertex.color.b) << 8)  |  static_cast<SPuint32>(vertex.color.a));
+            return key;
+        }
+
+        bool same_vertex(const Vertex& v1, const Vertex& v2)
+        {
+            return float_bits(v1.position.x)  == float_bits(v2.position.x)
+                && float_bits(v1.position.y)  == float_bits(v2.position.y)
+                && float_bits(v1.texCoords.x) == float_bits(v2.texCoords.x)
+                && float_bits(v1.texCoords.y) == float_bits(v2.texCoords.y)
+                && v1.color == v2.color;
+        }
+    }
+
+    MeshBuilder::MeshBuilder(Drawable& target, bool weld) :
+        m_target{target},
+        m_weld  {weld}
+    {
+    }
+
+    void MeshBuilder::reserve(size_t vertices, size_t indices)
+    {
+        m_target.m_vertices.reserve(m_target.m_vertices.size() + vertices);
+        m_target.m_indices.reserve(m_target.m_indices.size() + indices);
+    }
+
+    void MeshBuilder::setWelding(bool weld)
+    {
+        m_weld = weld;
+    }
+
+    bool MeshBuilder::isWelding() const
+    {
+        return m_weld;
+    }
+
+    void MeshBuilder::add(const Vertex& vertex)
+    {
+        m_target.m_indices.push_back(addVertex(vertex));
+    }
+
+    unsigned int MeshBuilder::addVertex(const Vertex& vertex)
+    {
+        if(!m_weld)
+            return append(vertex);
+
+        std::vector<Vertex>& vertices = m_target.m_vertices;
+        SPuint64 key = vertex_key(vertex);
+        auto it = m_target.m_weld_index.find(key);
+
+        //the index may outlive vertices that were cleared or rewritten since..
+        if(it != m_target.m_weld_index.end() && it->second < vertices.size() && same_vertex(vertices[it->second], vertex))
+            return it->second;
+
+        unsigned int index = append(vertex);
+        m_target.m_weld_index[key] = index;
+        return index;
+    }
+
+    unsigned int MeshBuilder::addVertices(const Vertex* vertices, size_t count)
+    {
+        unsigned int first = static_cast<unsigned int>(m_target.m_vertices.size());
+        m_target.m_vertices.reserve(m_target.m_vertices.size() + count);
+        for(size_t i = 0; i < count; ++i)
+            append(vertices[i]);
+        return first;
+    }
+
+    void MeshBuilder::addIndices(const unsigned int* indices, size_t count, unsigned int base)
+    {
+        std::vector<unsigned int>& target = m_target.m_indices;
+        size_t first = target.size();
+        target.resize(first + count);
+        for(size_t i = 0; i < count; ++i)
+            target[first + i] = base + indices[i];
+    }
+
+    void MeshBuilder::addTriangle(const Vertex& v1, const Vertex& v2, const Vertex& v3)
+    {
+        add(v1);
+        add(v2);
+        add(v3);
+    }
+
+    void MeshBuilder::addQuad(const Vertex& tl, const Vertex& tr, const Vertex& bl, const Vertex& br)
+    {
+        if(!m_weld)
+        {
+            unsigned int first = append(tl);
+            append(tr);
+            append(bl);
+            append(br);
+            addIndices(quad_indices, 6, first);
+            return;
+        }
+
+        unsigned int corners[4] = {addVertex(tl), addVertex(tr), addVertex(bl), addVertex(br)};
+        for(unsigned int index : quad_indices)
+            m_target.m_indices.push_back(corners[index]);
+    }
+
+    void MeshBuilder::addQuads(const Vertex* vertices, size_t quad_count)
+    {
+        reserve(quad_count * 4, quad_count * 6);
+        for(size_t quad = 0; quad < quad_count; ++quad)
+        {
+            const Vertex* corners = vertices + quad * 4;
+            addQuad(corners[0], corners[1], corners[2], corners[3]);
+        }
+    }
+
+    void MeshBuilder::addStrip(const Vertex* vertices, size_t count)
+    {
+        if(count < 3)
+            return;
+
+        std::vector<unsigned int> strip(count);
+        for(size_t i = 0; i < count; ++i)
+            strip[i] = addVertex(vertices[i]);
+
+        //every other triangle is flipped to keep the winding..
+        std::vector<unsigned int>& indices = m_target.m_indices;
+        indices.reserve(indices.size() + (count - 2) * 3);
+        for(size_t i = 0; i + 2 < count; ++i)
+        {
+            indices.push_back(strip[i % 2 ? i + 1 : i]);
+            indices.push_back(strip[i % 2 ? i : i + 1]);
+            indices.push_back(strip[i + 2]);
+        }
+    }
+
+    size_t MeshBuilder::getVertexCount() const
+    {
+        return m_target.m_vertices.size();
+    }
+
+    size_t MeshBuilder::getIndexCount() const
+    {
+        return m_target.m_indices.size();
+    }
+
+    unsigned int MeshBuilder::append(const Vertex& vertex)
+    {
+        //bounds grow the way Drawable::add always did..
+        rectf& bounds = m_target.m_drawable_states->bounds;
+        bounds.left   = std::min(bounds.left  , vertex.position.x);
+        bounds.top    = std::min(bounds.top   , vertex.position.y);
+        bounds.width  = std::max(bounds.width , vertex.position.x);
+        bounds.height = std::max(bounds.height, vertex.position.y);
+
+        m_target.m_vertices.push_back(vertex);
+        return static_cast<unsigned int>(m_target.m_vertices.size() - 1);
+    }
+}
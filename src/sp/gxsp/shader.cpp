@@ -2,6 +2,10 @@
 #include <sp/utils/helpers.h>
 #include <sp/sp_controller.h>
 #include <sp/spgl.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
 
 #if defined(SP_SYSTEM_MACOS)
     #define to_GLhandle(x) reinterpret_cast<void*>(static_cast<ptrdiff_t>(x))
@@ -78,52 +82,245 @@ namespace sp
 
             return con;
         }
-    }
 
-    struct Uniform
-    {
-        public:
-            Uniform(Shader& shader, const char* name) :
-                save_program    {0},
-                target_program  {from_GLhandle(shader.m_native_shader)},
-                location        {-1}
+        const char      binary_magic[4] = {'S', 'P', 'P', 'B'};
+        const SPuint32  binary_version  = 2;
+
+        //bound before linking; part of the binary key, since a cached binary
+        //keeps the locations it was linked with..
+        struct AttributeBinding
+        {
+            unsigned int    location;
+            const char*     name;
+        };
+
+        const AttributeBinding attribute_bindings[] =
+        {
+            {Shader::UserData,  "sp_UserData"},
+            {Shader::Slot,      "sp_Slot"}
+        };
+
+        struct BinaryHeader
+        {
+            char        magic[4];
+            SPuint32    version;
+            SPuint64    driver;
+            SPuint32    format;
+            SPuint32    length;
+        };
+
+        SPuint64 fnv1a(const void* data, size_t length, SPuint64 value = 14695981039346656037ull)
+        {
+            const SPuint8* bytes = reinterpret_cast<const SPuint8*>(data);
+            for(size_t i = 0; i < length; ++i)
             {
-                if(target_program)
+                value ^= bytes[i];
+                value *= 1099511628211ull;
+            }
+            return value;
+        }
+
+        SPuint64 hash_source(const char* source, int length, SPuint64 value)
+        {
+            if(!source)
+                return fnv1a("", 1, value);
+            return fnv1a(source, length < 0 ? std::char_traits<char>::length(source) : static_cast<size_t>(length), value);
+        }
+
+        //binaries are only valid for the exact driver that produced them..
+        SPuint64 driver_hash()
+        {
+            static SPuint64 hash = 0;
+            if(!hash)
+            {
+                hash = 14695981039346656037ull;
+                const GLenum names[3] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+                for(GLenum name : names)
                 {
-                    spCheck(save_program = glGetHandleARB(GL_PROGRAM_OBJECT_ARB))
-                    if(target_program != save_program)
-                        spCheck(glUseProgramObjectARB(target_program))
+                    const GLubyte* value = NULL;
+                    spCheck(value = glGetString(name))
+                    if(value)
+                        hash = hash_source(reinterpret_cast<const char*>(value), -1, hash);
+                }
+            }
+            return hash;
+        }
+
+        SPuint64 program_key(const char* vshader, int vlength, const char* fshader, int flength)
+        {
+            SPuint64 key = hash_source(vshader, vlength, 14695981039346656037ull);
+            key = hash_source(fshader, flength, key ^ 0x9e3779b97f4a7c15ull);
+            for(const AttributeBinding& binding : attribute_bindings)
+            {
+                key = fnv1a(&binding.location, sizeof(binding.location), key);
+                key = hash_source(binding.name, -1, key);
+            }
+            return key;
+        }
+
+        std::string& cache_directory()
+        {
+            static std::string directory;
+            return directory;
+        }
+
+        const int unresolved_location = -2;
+
+        //the shader whose program is current, staged uniforms go straight through..
+        const Shader*& bound_shader()
+        {
+            static const Shader* shader = nullptr;
+            return shader;
+        }
 
-                    location = shader.getUniformLocation(name);
+        bool& batch_active()
+        {
+            static bool active = false;
+            return active;
+        }
+
+        std::vector<Shader*>& pending_shaders()
+        {
+            static std::vector<Shader*> pending;
+            return pending;
+        }
+
+        bool program_binary_supported()
+        {
+            static char checked   = 0;
+            static char available = 0;
+            if(!checked)
+            {
+                checked = 1;
+                GLint formats = 0;
+                if(GL_ARB_get_program_binary_supported)
+                {
+                    spCheck(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats))
                 }
+                available = formats > 0;
+            }
+            return available && !cache_directory().empty();
+        }
+
+        std::string cache_path(SPuint64 key)
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "/%016llx.spbin", static_cast<unsigned long long>(key));
+            return cache_directory() + name;
+        }
+
+        bool load_program_binary(GLuint program, SPuint64 key)
+        {
+            if(!program_binary_supported())
+                return false;
+
+            std::string path = cache_path(key);
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if(!file)
+                return false;
+
+            BinaryHeader header;
+            std::vector<char> binary;
+            bool valid = std::fread(&header, sizeof(header), 1, file) == 1
+                      && std::equal(header.magic, header.magic + 4, binary_magic)
+                      && header.version == binary_version
+                      && header.driver  == driver_hash();
+            if(valid)
+            {
+                binary.resize(header.length);
+                valid = std::fread(binary.data(), 1, binary.size(), file) == binary.size();
             }
+            std::fclose(file);
 
-           ~Uniform()
+            GLint success = GL_FALSE;
+            if(valid)
             {
-                if(target_program && (target_program != save_program))
-                    spCheck(glUseProgramObjectARB(save_program));
+                spCheck(glProgramBinary(program, header.format, binary.data(), header.length))
+                spCheck(glGetProgramiv(program, GL_LINK_STATUS, &success))
             }
-            Uniform(const Uniform&) = delete;
-            Uniform& operator=(const Uniform&) = delete;
-            Uniform(Uniform&&) = delete;
-            Uniform& operator=(Uniform&&) = delete;
 
-            GLhandleARB         save_program;
-            GLhandleARB         target_program;
-            GLint               location;
-    };
+            //stale or foreign binaries are dropped and rebuilt from source..
+            if(success != GL_TRUE)
+                std::remove(path.c_str());
+            return success == GL_TRUE;
+        }
+
+        void store_program_binary(GLuint program, SPuint64 key)
+        {
+            if(!program_binary_supported())
+                return;
+
+            GLint length = 0;
+            spCheck(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length))
+            if(length <= 0)
+                return;
+
+            std::vector<char> binary(length);
+            GLenum format = 0;
+            spCheck(glGetProgramBinary(program, length, &length, &format, binary.data()))
+
+            BinaryHeader header;
+            std::copy(binary_magic, binary_magic + 4, header.magic);
+            header.version = binary_version;
+            header.driver  = driver_hash();
+            header.format  = format;
+            header.length  = static_cast<SPuint32>(length);
+
+            std::string path = cache_path(key);
+            std::FILE* file = std::fopen(path.c_str(), "wb");
+            if(!file)
+            {
+                SP_PRINT_WARNING("cannot write program binary " << path);
+                return;
+            }
+
+            bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+                        && std::fwrite(binary.data(), 1, length, file) == static_cast<size_t>(length);
+            std::fclose(file);
+            if(!written)
+                std::remove(path.c_str());
+        }
+
+        bool attach_stage(GLhandleARB program, GLenum type, const char* source, GLint length, bool check)
+        {
+            GLhandleARB shader;
+            spCheck(shader = glCreateShaderObjectARB(type))
+            spCheck(glShaderSourceARB(shader, 1, &source, &length))
+            spCheck(glCompileShaderARB(shader))
+
+            if(check)
+            {
+                GLint success;
+                spCheck(glGetObjectParameterivARB(shader, GL_OBJECT_COMPILE_STATUS_ARB, &success))
+                if(!success)
+                {
+                    char log[1024];
+                    spCheck(glGetInfoLogARB(shader, sizeof(log), 0, log))
+                    SP_PRINT_WARNING((type == GL_VERTEX_SHADER_ARB ? "vertex" : "fragment") << " shader compilation failed:\n" << log);
+                    spCheck(glDeleteObjectARB(shader))
+                    return false;
+                }
+            }
+
+            //flagged for deletion, freed along with the program..
+            spCheck(glAttachObjectARB(program, shader))
+            spCheck(glDeleteObjectARB(shader))
+            return true;
+        }
+    }
 
     Shader::Shader() :
         m_native_shader{0},
-        m_current_texture{-1}
+        m_current_texture{-1},
+        m_program_key{0},
+        m_pending{false}
     {
 
     }
 
     Shader::~Shader()
     {
-        if(m_native_shader)
-            spCheck(glDeleteObjectARB(m_native_shader))
+        release();
     }
 
     bool Shader::loadFromFile(const char* filename, SP_Program pr)
@@ -174,6 +371,17 @@ namespace sp
     {
         return compile(reinterpret_cast<const char*>(vdata), reinterpret_cast<const char*>(fdata));
     }
+
+    bool Shader::loadFromMemory(const void* data, size_t length, SP_Program pr)
+    {
+        m_type = pr;
+        return compile(reinterpret_cast<const char*>(data), static_cast<int>(length));
+    }
+
+    bool Shader::loadFromMemory(const void* vdata, size_t vlength, const void* fdata, size_t flength)
+    {
+        return compile(reinterpret_cast<const char*>(vdata), reinterpret_cast<const char*>(fdata), static_cast<int>(vlength), static_cast<int>(flength));
+    }
     bool Shader::shader_objects_supported()
     {
         static char checked   = 0;
@@ -190,7 +398,14 @@ namespace sp
         return available;
     }
 
-    bool Shader::compile(const char* source)
+    bool Shader::compile(const char* source, int length)
+    {
+        if(m_type == SP_Program::Vertex)
+            return compile(source, nullptr, length, -1);
+        return compile(nullptr, source, -1, length);
+    }
+
+    bool Shader::compile(const char* vshader, const char* fshader, int vlength, int flength)
     {
         if(!shader_objects_supported())
         {
@@ -198,63 +413,108 @@ namespace sp
             return false;
         }
 
-        if(m_native_shader)
-        {
-            spCheck(glDeleteObjectARB(to_GLhandle(m_native_shader)))
-            m_native_shader = 0;
-        }
+        release();
 
         m_current_texture = -1;
         m_texture_map.clear();
-        m_uniform_map.clear();
+
+        //locations are resolved again on the next bind, staged values survive..
+        m_dirty_uniforms.clear();
+        for(size_t i = 0; i < m_uniforms.size(); ++i)
+        {
+            UniformSlot& slot = m_uniforms[i];
+            slot.location = unresolved_location;
+            slot.dirty    = slot.type != SP_UniformType::None;
+            if(slot.dirty)
+                m_dirty_uniforms.push_back(static_cast<int>(i));
+        }
 
         GLhandleARB shaderProgram;
         spCheck(shaderProgram = glCreateProgramObjectARB());
 
-        GLhandleARB shader;
-        spCheck(shader = glCreateShaderObjectARB(m_type == SP_Program::Vertex ? GL_VERTEX_SHADER_ARB : GL_FRAGMENT_SHADER_ARB))
-        spCheck(glShaderSourceARB(shader, 1, &source, NULL))
-        spCheck(glCompileShaderARB(shader))
+        m_program_key = program_key(vshader, vlength, fshader, flength);
+        if(load_program_binary(from_GLhandle(shaderProgram), m_program_key))
+        {
+            m_native_shader = from_GLhandle(shaderProgram);
+            return true;
+        }
 
-        GLint success;
-        spCheck(glGetObjectParameterivARB(shader, GL_OBJECT_COMPILE_STATUS_ARB, &success))
-        if(!success)
+        //compile status is only checked right away outside of a batch..
+        const bool deferred = batch_active();
+        if((vshader && !attach_stage(shaderProgram, GL_VERTEX_SHADER_ARB,   vshader, vlength, !deferred))
+        || (fshader && !attach_stage(shaderProgram, GL_FRAGMENT_SHADER_ARB, fshader, flength, !deferred)))
         {
-            char log[1024];
-            spCheck(glGetInfoLogARB(shader, sizeof(log), 0, log))
-            SP_PRINT_WARNING("shader compilation failed:\n" << log);
-            spCheck(glDeleteObjectARB(shader))
             spCheck(glDeleteObjectARB(shaderProgram))
             return false;
         }
-        spCheck(glAttachObjectARB(shaderProgram, shader))
-        spCheck(glDeleteObjectARB(shader))
 
+        for(const AttributeBinding& binding : attribute_bindings)
+        {
+            spCheck(glBindAttribLocationARB(shaderProgram, binding.location, binding.name))
+        }
+        if(program_binary_supported())
+        {
+            spCheck(glProgramParameteri(from_GLhandle(shaderProgram), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE))
+        }
         spCheck(glLinkProgramARB(shaderProgram))
 
-        success = 0;
+        m_native_shader = from_GLhandle(shaderProgram);
+        if(deferred)
+        {
+            m_pending = true;
+            pending_shaders().push_back(this);
+            return true;
+        }
+
+        return finishLink();
+    }
+
+    bool Shader::finishLink()
+    {
+        m_pending = false;
+
+        GLhandleARB shaderProgram = to_GLhandle(m_native_shader);
+        GLint success = 0;
         spCheck(glGetObjectParameterivARB(shaderProgram, GL_OBJECT_LINK_STATUS_ARB, &success))
         if(success == GL_FALSE)
         {
+            //compile errors of deferred stages surface here as well..
+            GLhandleARB stages[2];
+            GLsizei count = 0;
+            spCheck(glGetAttachedObjectsARB(shaderProgram, 2, &count, stages))
+            for(GLsizei i = 0; i < count; ++i)
+            {
+                GLint compiled = 0;
+                spCheck(glGetObjectParameterivARB(stages[i], GL_OBJECT_COMPILE_STATUS_ARB, &compiled))
+                if(!compiled)
+                {
+                    char log[1024];
+                    spCheck(glGetInfoLogARB(stages[i], sizeof(log), 0, log))
+                    SP_PRINT_WARNING("shader compilation failed:\n" << log);
+                }
+            }
+
             char log[1024];
             spCheck(glGetInfoLogARB(shaderProgram, sizeof(log), 0, log))
             SP_PRINT_WARNING("shader compilation failed:\n" << log);
             spCheck(glDeleteObjectARB(shaderProgram))
+            m_native_shader = 0;
             return false;
         }
 
-        m_native_shader = from_GLhandle(shaderProgram);
+        store_program_binary(m_native_shader, m_program_key);
 
         spCheck(glFlush())
         return true;
     }
 
-    bool Shader::compile(const char* vshader, const char* fshader)
+    void Shader::release()
     {
-        if(!shader_objects_supported())
+        if(m_pending)
         {
-            SP_PRINT_WARNING("shader objects not supported");
-            return false;
+            auto& pending = pending_shaders();
+            pending.erase(std::remove(pending.begin(), pending.end(), this), pending.end());
+            m_pending = false;
         }
 
         if(m_native_shader)
@@ -263,144 +523,324 @@ namespace sp
             m_native_shader = 0;
         }
 
-        m_current_texture = -1;
-        m_texture_map.clear();
-        m_uniform_map.clear();
+        if(bound_shader() == this)
+            bound_shader() = nullptr;
+    }
 
-        GLhandleARB shaderProgram;
-        spCheck(shaderProgram = glCreateProgramObjectARB());
+    void Shader::setProgramCacheDirectory(const char* directory)
+    {
+        cache_directory() = directory ? directory : "";
+    }
 
-        if(vshader)
+    void Shader::beginBatch()
+    {
+        if(batch_active())
+            return;
+
+        batch_active() = true;
+        if(GL_KHR_parallel_shader_compile_supported)
         {
-            GLhandleARB shader;
-            spCheck(shader = glCreateShaderObjectARB(GL_VERTEX_SHADER_ARB))
-            spCheck(glShaderSourceARB(shader, 1, &vshader, NULL))
-            spCheck(glCompileShaderARB(shader))
+            //let the driver pick the number of compiler threads..
+            spCheck(glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu))
+        }
+    }
 
-            GLint success;
-            spCheck(glGetObjectParameterivARB(shader, GL_OBJECT_COMPILE_STATUS_ARB, &success))
-            if(!success)
-            {
-                char log[1024];
-                spCheck(glGetInfoLogARB(shader, sizeof(log), 0, log))
-                SP_PRINT_WARNING("vertex shader compilation failed:\n" << log);
-                spCheck(glDeleteObjectARB(shader))
-                spCheck(glDeleteObjectARB(shaderProgram))
-                return false;
-            }
-            spCheck(glAttachObjectARB(shaderProgram, shader))
-            spCheck(glDeleteObjectARB(shader))
+    bool Shader::endBatch()
+    {
+        batch_active() = false;
+
+        //links are collected in submission order, by then most of them are done..
+        bool status = true;
+        std::vector<Shader*> pending;
+        pending.swap(pending_shaders());
+        for(Shader* shader : pending)
+            status = shader->finishLink() && status;
+        return status;
+    }
+
+    bool Shader::isReady() const
+    {
+        if(!m_pending)
+            return m_native_shader != 0;
+
+        if(!GL_KHR_parallel_shader_compile_supported)
+            return true;
+
+        GLint done = GL_FALSE;
+        spCheck(glGetProgramiv(from_GLhandle(to_GLhandle(m_native_shader)), GL_COMPLETION_STATUS_KHR, &done))
+        return done == GL_TRUE;
+    }
+
+    int Shader::uniform(const char* name)
+    {
+        auto it = m_uniform_ids.find(name);
+        if(it != m_uniform_ids.end())
+            return it->second;
+
+        UniformSlot slot;
+        slot.name       = name;
+        slot.location   = unresolved_location;
+        slot.type       = SP_UniformType::None;
+        slot.count      = 0;
+        slot.offset     = 0;
+        slot.size       = 0;
+        slot.capacity   = 0;
+        slot.dirty      = false;
+
+        int id = static_cast<int>(m_uniforms.size());
+        m_uniforms.push_back(slot);
+        m_uniform_ids.insert(std::make_pair(slot.name, id));
+        return id;
+    }
+
+    int  Shader::getUniformLocation(const char* name)
+    {
+        UniformSlot& slot = m_uniforms[uniform(name)];
+        if(slot.location == unresolved_location && m_native_shader)
+        {
+            spCheck(slot.location = glGetUniformLocationARB(to_GLhandle(m_native_shader), name))
+            if(slot.location == -1)
+                SP_PRINT_WARNING("uniform location " << name << " not found");
         }
+        return slot.location;
+    }
+
+    void Shader::stage(int id, SP_UniformType type, const void* data, size_t size, size_t count)
+    {
+        if(id < 0 || static_cast<size_t>(id) >= m_uniforms.size() || !size)
+            return;
+
+        UniformSlot& slot = m_uniforms[id];
+        if(slot.location == -1)
+            return;
 
-        if(fshader)
+        if(size > slot.capacity)
         {
-            GLhandleARB shader;
-            spCheck(shader = glCreateShaderObjectARB(GL_FRAGMENT_SHADER_ARB))
-            spCheck(glShaderSourceARB(shader, 1, &fshader, NULL))
-            spCheck(glCompileShaderARB(shader))
+            slot.offset   = m_uniform_block.size();
+            slot.capacity = size;
+            m_uniform_block.resize(slot.offset + size);
+        }
+        else if(slot.type == type && slot.size == size && !std::memcmp(&m_uniform_block[slot.offset], data, size))
+        {
+            //unchanged values are not uploaded again..
+            return;
+        }
 
-            GLint success;
-            spCheck(glGetObjectParameterivARB(shader, GL_OBJECT_COMPILE_STATUS_ARB, &success))
-            if(!success)
-            {
-                char log[1024];
-                spCheck(glGetInfoLogARB(shader, sizeof(log), 0, log))
-                SP_PRINT_WARNING("fragment shader compilation failed:\n" << log);
-                spCheck(glDeleteObjectARB(shader))
-                spCheck(glDeleteObjectARB(shaderProgram))
-                return false;
-            }
-            spCheck(glAttachObjectARB(shaderProgram, shader))
-            spCheck(glDeleteObjectARB(shader))
+        std::memcpy(&m_uniform_block[slot.offset], data, size);
+        slot.type  = type;
+        slot.size  = size;
+        slot.count = static_cast<SPuint32>(count);
+
+        if(!slot.dirty)
+        {
+            slot.dirty = true;
+            m_dirty_uniforms.push_back(id);
         }
 
-        spCheck(glLinkProgramARB(shaderProgram))
+        if(bound_shader() == this)
+            flushUniforms();
+    }
 
-        GLint success = 0;
-        spCheck(glGetObjectParameterivARB(shaderProgram, GL_OBJECT_LINK_STATUS_ARB, &success))
-        if(success == GL_FALSE)
+    void Shader::flushUniforms() const
+    {
+        if(m_dirty_uniforms.empty() || bound_shader() != this || !m_native_shader)
+            return;
+
+        for(int id : m_dirty_uniforms)
         {
-            char log[1024];
-            spCheck(glGetInfoLogARB(shaderProgram, sizeof(log), 0, log))
-            SP_PRINT_WARNING("shader compilation failed:\n" << log);
-            spCheck(glDeleteObjectARB(shaderProgram))
-            return false;
+            UniformSlot& slot = m_uniforms[id];
+            slot.dirty = false;
+
+            if(slot.location == unresolved_location)
+            {
+                spCheck(slot.location = glGetUniformLocationARB(to_GLhandle(m_native_shader), slot.name.c_str()))
+                if(slot.location == -1)
+                    SP_PRINT_WARNING("uniform location " << slot.name.c_str() << " not found");
+            }
+            if(slot.location == -1)
+                continue;
+
+            const GLint    location = slot.location;
+            const GLsizei  count    = static_cast<GLsizei>(slot.count);
+            const GLfloat* fvalue   = reinterpret_cast<const GLfloat*>(&m_uniform_block[slot.offset]);
+            const GLint*   ivalue   = reinterpret_cast<const GLint*>(&m_uniform_block[slot.offset]);
+
+            switch(slot.type)
+            {
+                case SP_UniformType::Float1: spCheck(glUniform1fvARB(location, count, fvalue)) break;
+                case SP_UniformType::Float2: spCheck(glUniform2fvARB(location, count, fvalue)) break;
+                case SP_UniformType::Float3: spCheck(glUniform3fvARB(location, count, fvalue)) break;
+                case SP_UniformType::Float4: spCheck(glUniform4fvARB(location, count, fvalue)) break;
+                case SP_UniformType::Int1:   spCheck(glUniform1ivARB(location, count, ivalue)) break;
+                case SP_UniformType::Int2:   spCheck(glUniform2ivARB(location, count, ivalue)) break;
+                case SP_UniformType::Int3:   spCheck(glUniform3ivARB(location, count, ivalue)) break;
+                case SP_UniformType::Int4:   spCheck(glUniform4ivARB(location, count, ivalue)) break;
+                case SP_UniformType::Mat3:   spCheck(glUniformMatrix3fvARB(location, count, GL_FALSE, fvalue)) break;
+                case SP_UniformType::Mat4:   spCheck(glUniformMatrix4fvARB(location, count, GL_FALSE, fvalue)) break;
+                default: break;
+            }
         }
+        m_dirty_uniforms.clear();
+    }
 
-        m_native_shader = from_GLhandle(shaderProgram);
+    void Shader::setUniform(int id, float val)
+    {
+        stage(id, SP_UniformType::Float1, &val, sizeof(float), 1);
+    }
 
-        spCheck(glFlush())
-        return true;
+    void Shader::setUniform(int id, const gl::vec2f& val)
+    {
+        const float con[2] = {val.x, val.y};
+        stage(id, SP_UniformType::Float2, con, sizeof(con), 1);
     }
 
-    int  Shader::getUniformLocation(const char* name)
+    void Shader::setUniform(int id, const gl::vec3f& val)
     {
-        auto it = m_uniform_map.find(String(name));
-        if(it != m_uniform_map.end())
-            return it->second;
+        const float con[3] = {val.x, val.y, val.z};
+        stage(id, SP_UniformType::Float3, con, sizeof(con), 1);
+    }
+
+    void Shader::setUniform(int id, const gl::vec4f& val)
+    {
+        const float con[4] = {val.x, val.y, val.z, val.w};
+        stage(id, SP_UniformType::Float4, con, sizeof(con), 1);
+    }
+
+    void Shader::setUniform(int id, int val)
+    {
+        stage(id, SP_UniformType::Int1, &val, sizeof(int), 1);
+    }
+
+    void Shader::setUniform(int id, const gl::vec2i& val)
+    {
+        const int con[2] = {val.x, val.y};
+        stage(id, SP_UniformType::Int2, con, sizeof(con), 1);
+    }
+
+    void Shader::setUniform(int id, const gl::vec3i& val)
+    {
+        const int con[3] = {val.x, val.y, val.z};
+        stage(id, SP_UniformType::Int3, con, sizeof(con), 1);
+    }
 
-        int location = glGetUniformLocationARB(to_GLhandle(m_native_shader), name);
-        m_uniform_map.insert(std::make_pair(String(name), location));
-        if(location == -1)
-            SP_PRINT_WARNING("uniform location " << name << " not found");
+    void Shader::setUniform(int id, const gl::vec4i& val)
+    {
+        const int con[4] = {val.x, val.y, val.z, val.w};
+        stage(id, SP_UniformType::Int4, con, sizeof(con), 1);
+    }
+
+    void Shader::setUniform(int id, const gl::mat3& val)
+    {
+        stage(id, SP_UniformType::Mat3, val.pointer, 3 * 3 * sizeof(float), 1);
+    }
 
-        return location;
+    void Shader::setUniform(int id, const gl::mat4& val)
+    {
+        stage(id, SP_UniformType::Mat4, val.pointer, 4 * 4 * sizeof(float), 1);
     }
+
+    void Shader::setUniformArray(int id, const float* pointer, size_t length)
+    {
+        stage(id, SP_UniformType::Float1, pointer, length * sizeof(float), length);
+    }
+
+    void Shader::setUniformArray(int id, const gl::vec2f* pointer, size_t length)
+    {
+        std::vector<float> con = flatten(pointer, length);
+        stage(id, SP_UniformType::Float2, con.data(), con.size() * sizeof(float), length);
+    }
+
+    void Shader::setUniformArray(int id, const gl::vec3f* pointer, size_t length)
+    {
+        std::vector<float> con = flatten(pointer, length);
+        stage(id, SP_UniformType::Float3, con.data(), con.size() * sizeof(float), length);
+    }
+
+    void Shader::setUniformArray(int id, const gl::vec4f* pointer, size_t length)
+    {
+        std::vector<float> con = flatten(pointer, length);
+        stage(id, SP_UniformType::Float4, con.data(), con.size() * sizeof(float), length);
+    }
+
+    void Shader::setUniformArray(int id, const int* pointer, size_t length)
+    {
+        stage(id, SP_UniformType::Int1, pointer, length * sizeof(int), length);
+    }
+
+    void Shader::setUniformArray(int id, const gl::vec2i* pointer, size_t length)
+    {
+        std::vector<int> con = flatten(pointer, length);
+        stage(id, SP_UniformType::Int2, con.data(), con.size() * sizeof(int), length);
+    }
+
+    void Shader::setUniformArray(int id, const gl::vec3i* pointer, size_t length)
+    {
+        std::vector<int> con = flatten(pointer, length);
+        stage(id, SP_UniformType::Int3, con.data(), con.size() * sizeof(int), length);
+    }
+
+    void Shader::setUniformArray(int id, const gl::vec4i* pointer, size_t length)
+    {
+        std::vector<int> con = flatten(pointer, length);
+        stage(id, SP_UniformType::Int4, con.data(), con.size() * sizeof(int), length);
+    }
+
+    void Shader::setUniformArray(int id, const gl::mat3* pointer, size_t length)
+    {
+        const std::size_t matrix_size = 3 * 3;
+        std::vector<float> con(matrix_size * length);
+        for(size_t i = 0; i < length; ++i)
+            gl::spCopyMat(pointer[i].pointer, matrix_size, &con[matrix_size * i]);
+        stage(id, SP_UniformType::Mat3, con.data(), con.size() * sizeof(float), length);
+    }
+
+    void Shader::setUniformArray(int id, const gl::mat4* pointer, size_t length)
+    {
+        const std::size_t matrix_size = 4 * 4;
+        std::vector<float> con(matrix_size * length);
+        for(size_t i = 0; i < length; ++i)
+            gl::spCopyMat(pointer[i].pointer, matrix_size, &con[matrix_size * i]);
+        stage(id, SP_UniformType::Mat4, con.data(), con.size() * sizeof(float), length);
+    }
+
     void Shader::setUniform(const char* name, float val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform1fARB(binder.location, val));
+        setUniform(uniform(name), val);
     }
 
     void Shader::setUniform(const char* name, const gl::vec2f& val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform2fARB(binder.location, val.x, val.y));
+        setUniform(uniform(name), val);
     }
 
     void Shader::setUniform(const char* name, const gl::vec3f& val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform3fARB(binder.location, val.x, val.y, val.z));
+        setUniform(uniform(name), val);
     }
 
     void Shader::setUniform(const char* name, const gl::vec4f& val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform4fARB(binder.location, val.x, val.y, val.z, val.w));
+        setUniform(uniform(name), val);
     }
 
-
     void Shader::setUniform(const char* name, int val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform1iARB(binder.location, val));
+        setUniform(uniform(name), val);
     }
 
     void Shader::setUniform(const char* name, const gl::vec2i& val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform2iARB(binder.location, val.x, val.y));
+        setUniform(uniform(name), val);
     }
 
     void Shader::setUniform(const char* name, const gl::vec3i& val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform3iARB(binder.location, val.x, val.y, val.z));
+        setUniform(uniform(name), val);
     }
 
     void Shader::setUniform(const char* name, const gl::vec4i& val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform4iARB(binder.location, val.x, val.y, val.z, val.w));
+        setUniform(uniform(name), val);
     }
 
     void Shader::setUniform(const char* name, bool val)
@@ -423,23 +863,16 @@ namespace sp
         setUniform(name, static_cast<gl::vec4i>(val));
     }
 
-
     void Shader::setUniform(const char* name, const gl::mat3& val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniformMatrix3fvARB(binder.location, 1, GL_FALSE, val.pointer));
+        setUniform(uniform(name), val);
     }
 
     void Shader::setUniform(const char* name, const gl::mat4& val)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniformMatrix4fvARB(binder.location, 1, GL_FALSE, val.pointer));
+        setUniform(uniform(name), val);
     }
 
-
-
     void Shader::setUniformTexture(const char* name, unsigned texture)
     {
         if(m_native_shader)
@@ -469,91 +902,52 @@ namespace sp
 
     void Shader::setUniformArray(const char* name, const float* pointer, size_t length)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform1fvARB(binder.location, static_cast<GLsizei>(length), pointer))
+        setUniformArray(uniform(name), pointer, length);
     }
 
-
     void Shader::setUniformArray(const char* name, const gl::vec2f* pointer, size_t length)
     {
-        std::vector<float> con = flatten(pointer, length);
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform2fvARB(binder.location, static_cast<GLsizei>(length), &con[0]))
+        setUniformArray(uniform(name), pointer, length);
     }
 
-
     void Shader::setUniformArray(const char* name, const gl::vec3f* pointer, size_t length)
     {
-        std::vector<float> con = flatten(pointer, length);
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform3fvARB(binder.location, static_cast<GLsizei>(length), &con[0]))
+        setUniformArray(uniform(name), pointer, length);
     }
 
     void Shader::setUniformArray(const char* name, const gl::vec4f* pointer, size_t length)
     {
-      std::vector<float> con = flatten(pointer, length);
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform4fvARB(binder.location, static_cast<GLsizei>(length), &con[0]))
+        setUniformArray(uniform(name), pointer, length);
     }
 
     void Shader::setUniformArray(const char* name, const int* pointer, size_t length)
     {
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform1ivARB(binder.location, static_cast<GLsizei>(length), pointer))
+        setUniformArray(uniform(name), pointer, length);
     }
 
     void Shader::setUniformArray(const char* name, const gl::vec2i* pointer, size_t length)
     {
-        std::vector<int> con = flatten(pointer, length);
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform2ivARB(binder.location, static_cast<GLsizei>(length), &con[0]))
+        setUniformArray(uniform(name), pointer, length);
     }
 
     void Shader::setUniformArray(const char* name, const gl::vec3i* pointer, size_t length)
     {
-        std::vector<int> con = flatten(pointer, length);
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform3ivARB(binder.location, static_cast<GLsizei>(length), &con[0]))
+        setUniformArray(uniform(name), pointer, length);
     }
 
     void Shader::setUniformArray(const char* name, const gl::vec4i* pointer, size_t length)
     {
-        std::vector<int> con = flatten(pointer, length);
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniform4ivARB(binder.location, static_cast<GLsizei>(length), &con[0]))
+        setUniformArray(uniform(name), pointer, length);
     }
 
     void Shader::setUniformArray(const char* name, const gl::mat3* pointer, size_t length)
     {
-        const std::size_t matrix_size = 3 * 3;
-        std::vector<float> con(matrix_size * length);
-        for(size_t i = 0; i < length; ++i)
-            gl::spCopyMat(pointer[i].pointer, matrix_size, &con[matrix_size * i]);
-
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniformMatrix3fvARB(binder.location, static_cast<GLsizei>(length), GL_FALSE, &con[0]))
+        setUniformArray(uniform(name), pointer, length);
     }
 
-
     void Shader::setUniformArray(const char* name, const gl::mat4* pointer, size_t length)
     {
-        const std::size_t matrix_size = 4 * 4;
-        std::vector<float> con(matrix_size * length);
-        for(size_t i = 0; i < length; ++i)
-            gl::spCopyMat(pointer[i].pointer, matrix_size, &con[matrix_size * i]);
-
-        Uniform binder(*this, name);
-        if(binder.location != -1)
-            spCheck(glUniformMatrix4fvARB(binder.location, static_cast<GLsizei>(length), GL_FALSE, &con[0]))
+        setUniformArray(uniform(name), pointer, length);
     }
 
     void Shader::bindTextures() const
@@ -578,6 +972,8 @@ namespace sp
         if(shader && shader->m_native_shader)
         {
             spCheck(glUseProgramObjectARB(to_GLhandle(shader->m_native_shader)))
+            bound_shader() = shader;
+            shader->flushUniforms();
             shader->bindTextures();
             if(shader->m_current_texture != -1)
             {
@@ -587,6 +983,7 @@ namespace sp
         else
         {
             spCheck(glUseProgramObjectARB(0))
+            bound_shader() = nullptr;
         }
     }
 
@@ -1,5 +1,6 @@
 #include <sp/gxsp/sprite.h>
 #include <sp/gxsp/batch_renderer.h>
+#include <sp/gxsp/mesh_builder.h>
 
 namespace sp
 {
@@ -8,24 +9,8 @@ namespace sp
         m_custom_size{false},
         m_origin     {}
     {
-        m_vertices.reserve(4);
-        m_indices.reserve(6);
-#if defined(SP_INITIALIZER_LIST_SUPPORTED)
-        m_indices   = {0, 1, 2, 2, 1, 3};
-        m_vertices  = {};
-#else
-        m_indices.push_back(0);
-        m_indices.push_back(1);
-        m_indices.push_back(2);
-        m_indices.push_back(2);
-        m_indices.push_back(1);
-        m_indices.push_back(3);
-
-        m_vertices.push_back(sp::Vertex{});
-        m_vertices.push_back(sp::Vertex{});
-        m_vertices.push_back(sp::Vertex{});
-        m_vertices.push_back(sp::Vertex{});
-#endif
+        //one quad, the corners are placed by setTextureRect..
+        MeshBuilder(*this).addQuad(Vertex{}, Vertex{}, Vertex{}, Vertex{});
 
         m_drawable_states->states.viewport = &m_viewport;
         m_drawable_states->vertex_entry = 0;
@@ -39,25 +24,8 @@ namespace sp
         m_custom_size{false},
         m_origin     {}
     {
-        m_vertices.reserve(4);
-        m_indices.reserve(6);
-
-#if defined(SP_INITIALIZER_LIST_SUPPORTED)
-        m_indices = {0, 1, 2, 2, 1, 3};
-        m_vertices  = {};
-#else
-        m_indices.push_back(0);
-        m_indices.push_back(1);
-        m_indices.push_back(2);
-        m_indices.push_back(2);
-        m_indices.push_back(1);
-        m_indices.push_back(3);
-
-        m_vertices.push_back(sp::Vertex{});
-        m_vertices.push_back(sp::Vertex{});
-        m_vertices.push_back(sp::Vertex{});
-        m_vertices.push_back(sp::Vertex{});
-#endif
+        //one quad, the corners are placed by setTextureRect..
+        MeshBuilder(*this).addQuad(Vertex{}, Vertex{}, Vertex{}, Vertex{});
 
         setTextureSprite(texture, true);
         m_drawable_states->states.viewport = &m_viewport;
@@ -72,27 +40,10 @@ namespace sp
         m_custom_size{false},
         m_origin     {}
     {
-        m_vertices.reserve(4);
-        m_indices.reserve(6);
-
         m_drawable_states->update = true;
 
-#if defined(SP_INITIALIZER_LIST_SUPPORTED)
-        m_indices = {0, 1, 2, 2, 1, 3};
-        m_vertices  = {};
-#else
-        m_indices.push_back(0);
-        m_indices.push_back(1);
-        m_indices.push_back(2);
-        m_indices.push_back(2);
-        m_indices.push_back(1);
-        m_indices.push_back(3);
-
-        m_vertices.push_back(sp::Vertex{});
-        m_vertices.push_back(sp::Vertex{});
-        m_vertices.push_back(sp::Vertex{});
-        m_vertices.push_back(sp::Vertex{});
-#endif
+        //one quad, the corners are placed by setTextureRect..
+        MeshBuilder(*this).addQuad(Vertex{}, Vertex{}, Vertex{}, Vertex{});
 
         setTextureSprite(texture, true);
         setTextureRect(area);
@@ -179,7 +130,7 @@ namespace sp
 
     void Sprite::addDrawable(Renderer& renderer, bool max)
     {
-        renderer.addDrawable(m_drawable_states, max);
+        renderer.addDrawable(m_handle, max);
     }
     void Sprite::setSize(float width, float height)
     {
@@ -253,6 +204,15 @@ namespace sp
         m_drawable_states->update = true;
     }
 
+    void Sprite::setTexCoords(const rectf& coords)
+    {
+        m_vertices[0].texCoords = vec2f{coords.left,  coords.top};
+        m_vertices[1].texCoords = vec2f{coords.left,  coords.height};
+        m_vertices[2].texCoords = vec2f{coords.width, coords.top};
+        m_vertices[3].texCoords = vec2f{coords.width, coords.height};
+        m_drawable_states->update = true;
+    }
+
     void Sprite::setColor(const Color& color)
     {
         m_vertices[0].color = color;
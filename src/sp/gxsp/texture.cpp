@@ -1,12 +1,26 @@
 #include <sp/gxsp/texture.h>
+#include <sp/gxsp/compressed_image.h>
 #include <sp/utils/helpers.h>
 #include <sp/sp_controller.h>
 #include <sp/spgl.h>
+#include <vector>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SP_TEXTURE_SSE2
+    #include <emmintrin.h>
+#endif
+
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
 
 namespace sp
 {
     namespace
     {
+        bool premultiply_on_load = false;
+
         SPuint64 gen_unique_id()
         {
             static SPuint64 generator = 1;
@@ -23,6 +37,54 @@ namespace sp
             }
             return static_cast<unsigned int>(max_size);
         }
+
+        //scratch framebuffers used to address texture regions on the gpu..
+        //created once and re-attached on demand, instead of generating fbos per call..
+        GLuint scratch_framebuffer(unsigned int slot)
+        {
+            static GLuint framebuffers[2] = {0, 0};
+            if(!framebuffers[slot])
+            {
+                spCheck(glGenFramebuffersEXT(1, &framebuffers[slot]))
+            }
+            return framebuffers[slot];
+        }
+
+        //clips an area against the texture dimensions, returns false if nothing remains..
+        bool clip_area(recti& area, const vec2u& size)
+        {
+            if(area.left < 0) { area.width  += area.left; area.left = 0; }
+            if(area.top  < 0) { area.height += area.top;  area.top  = 0; }
+            if(area.left + area.width  > static_cast<int>(size.x)) area.width  = static_cast<int>(size.x) - area.left;
+            if(area.top  + area.height > static_cast<int>(size.y)) area.height = static_cast<int>(size.y) - area.top;
+            return area.width > 0 && area.height > 0;
+        }
+
+        GLenum compressed_format(CompressedImage::SP_Format format)
+        {
+            switch(format)
+            {
+                case CompressedImage::DXT1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                case CompressedImage::DXT3: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+                case CompressedImage::DXT5: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case CompressedImage::BC7:  return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+            }
+            return 0;
+        }
+
+        bool compressed_format_supported(CompressedImage::SP_Format format)
+        {
+            if(format == CompressedImage::BC7)
+                return GL_ARB_texture_compression_bptc_supported;
+            return GL_EXT_texture_compression_s3tc_supported;
+        }
+
+        bool has_extension(const char* filename, const char* extension)
+        {
+            size_t length = std::strlen(filename);
+            size_t ext    = std::strlen(extension);
+            return length >= ext && std::strcmp(filename + length - ext, extension) == 0;
+        }
     }
 
     Texture::Texture() :
@@ -33,6 +95,8 @@ namespace sp
         m_flipped           {false},
         m_is_fbo_attachment {false},
         m_mipmap_generated  {false},
+        m_compressed        {false},
+        m_premultiplied     {false},
         m_is_copy           {false},
         m_pbo_created       {false},
         m_api_id            {gen_unique_id()},
@@ -48,6 +112,8 @@ namespace sp
         m_flipped           {other.m_flipped},
         m_is_fbo_attachment {other.m_is_fbo_attachment},
         m_mipmap_generated  {other.m_mipmap_generated},
+        m_compressed        {other.m_compressed},
+        m_premultiplied     {other.m_premultiplied},
         m_is_copy           {true},
         m_pbo_created       {false},
         m_iformat           {other.m_iformat},
@@ -69,6 +135,8 @@ namespace sp
             m_flipped           = other.m_flipped;
             m_is_fbo_attachment = other.m_is_fbo_attachment;
             m_mipmap_generated  = other.m_mipmap_generated;
+            m_compressed        = other.m_compressed;
+            m_premultiplied     = other.m_premultiplied;
             m_iformat           = other.m_iformat;
             m_format            = other.m_format;
             m_api_id            = gen_unique_id();
@@ -123,6 +191,8 @@ namespace sp
         m_flipped           = false;
         m_is_fbo_attachment = false;
         m_mipmap_generated  = false;
+        m_compressed        = false;
+        m_premultiplied     = false;
 
         if(!m_tex_obj)
         {
@@ -137,6 +207,7 @@ namespace sp
         spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_repeated ? GL_REPEAT : GL_CLAMP_TO_EDGE_EXT))
         spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_smooth ? GL_LINEAR : GL_NEAREST))
         spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_smooth ? GL_LINEAR : GL_NEAREST))
+        spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000))
         m_api_id = gen_unique_id();
 
         m_iformat = iformat;
@@ -174,10 +245,79 @@ namespace sp
         m_flipped           = false;
         m_is_fbo_attachment = false;
         m_is_copy           = false;
+        m_compressed        = false;
+        m_premultiplied     = false;
+    }
+
+    void Texture::setPremultiplyOnLoad(bool premultiply)
+    {
+        premultiply_on_load = premultiply;
+    }
+
+    bool Texture::getPremultiplyOnLoad()
+    {
+        return premultiply_on_load;
+    }
+
+    bool Texture::isPremultiplied() const
+    {
+        return m_premultiplied;
+    }
+
+    //rgba8 in place, rgb * a / 255 rounded; alpha is kept..
+    void Texture::premultiply(SPuint8* pixels, size_t count)
+    {
+        size_t i = 0;
+#ifdef SP_TEXTURE_SSE2
+        //four pixels per register, widened to 16 bits two at a time..
+        const __m128i zero      = _mm_setzero_si128();
+        const __m128i rgb_mask  = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+        const __m128i alpha_one = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+        const __m128i half      = _mm_set1_epi16(128);
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128i* block = reinterpret_cast<__m128i*>(pixels + i * 4);
+            __m128i packed = _mm_loadu_si128(block);
+            __m128i halves[2] = {_mm_unpacklo_epi8(packed, zero), _mm_unpackhi_epi8(packed, zero)};
+            for(__m128i& half_pixels : halves)
+            {
+                __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(half_pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                alpha = _mm_or_si128(_mm_and_si128(alpha, rgb_mask), alpha_one);
+
+                __m128i product = _mm_add_epi16(_mm_mullo_epi16(half_pixels, alpha), half);
+                half_pixels = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+            }
+            _mm_storeu_si128(block, _mm_packus_epi16(halves[0], halves[1]));
+        }
+#endif
+        for(; i < count; ++i)
+        {
+            SPuint8* pixel = pixels + i * 4;
+            unsigned int alpha = pixel[3];
+            for(int c = 0; c < 3; ++c)
+            {
+                unsigned int product = pixel[c] * alpha + 128;
+                pixel[c] = static_cast<SPuint8>((product + (product >> 8)) >> 8);
+            }
+        }
     }
 
     //loads an image located in memory..
     bool Texture::loadFromMemory(const void* data, unsigned int width, unsigned int height, const recti& area)
+    {
+        if(!premultiply_on_load)
+            return loadPixels(data, width, height, area);
+
+        std::vector<SPuint8> pixels(reinterpret_cast<const SPuint8*>(data), reinterpret_cast<const SPuint8*>(data) + static_cast<size_t>(width) * height * 4);
+        premultiply(pixels.data(), static_cast<size_t>(width) * height);
+        if(!loadPixels(pixels.data(), width, height, area))
+            return false;
+
+        m_premultiplied = true;
+        return true;
+    }
+
+    bool Texture::loadPixels(const void* data, unsigned int width, unsigned int height, const recti& area)
     {
         if(area.width == 0 || area.height == 0 ||
           ((area.left <= 0) && (area.top <= 0) && (area.width >= static_cast<int>(width)) && (area.height >= static_cast<int>(height))))
@@ -215,8 +355,118 @@ namespace sp
 
         return false;
     }
+    //decodes an encoded image (png, tga, .. or a compressed container) located in memory..
+    bool Texture::loadFromMemory(const void* data, size_t size, const recti& area)
+    {
+        if(CompressedImage::isCompressedImage(data, size))
+        {
+            CompressedImage image;
+            return image.loadFromMemory(data, size) && loadFromCompressed(image);
+        }
+
+        int width  = 0;
+        int height = 0;
+        int channels = 0;
+        stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(data), static_cast<int>(size), &width, &height, &channels, 4);
+        if(!pixels)
+        {
+            SP_PRINT_WARNING("failed to decode image: " << stbi_failure_reason());
+            return false;
+        }
+
+        //decoded into a buffer of our own, so it is premultiplied in place..
+        if(premultiply_on_load)
+            premultiply(pixels, static_cast<size_t>(width) * height);
+
+        bool status = loadPixels(pixels, static_cast<unsigned int>(width), static_cast<unsigned int>(height), area);
+        m_premultiplied = status && premultiply_on_load;
+        stbi_image_free(pixels);
+        return status;
+    }
+
+    //uploads a pre-compressed mip chain as is, or decoded if the driver lacks the format..
+    bool Texture::loadFromCompressed(const CompressedImage& image)
+    {
+        unsigned int levels = image.getLevelCount();
+        if(!levels)
+        {
+            SP_PRINT_WARNING("cannot create texture from empty compressed image");
+            return false;
+        }
+
+        const vec2u& size = image.getSize();
+        unsigned int max_size = max_texture_size();
+        if(size.x > max_size || size.y > max_size)
+        {
+            SP_PRINT_WARNING("cannot create texture with exceeding dimensions (max size = " << max_size << ")");
+            return false;
+        }
+
+        if(!m_tex_obj)
+        {
+            GLuint texture = 0;
+            spCheck(glGenTextures(1, &texture));
+            m_tex_obj = static_cast<unsigned int>(texture);
+        }
+
+        const CompressedImage::SP_Format format = image.getFormat();
+        const bool native = compressed_format_supported(format);
+        const GLenum iformat = compressed_format(format);
+
+        std::vector<SPuint8> pixels;
+        spCheck(glBindTexture(GL_TEXTURE_2D, m_tex_obj))
+        for(unsigned int i = 0; i < levels; ++i)
+        {
+            const CompressedImage::Level& level = image.getLevel(i);
+            if(native)
+            {
+                spCheck(glCompressedTexImage2DARB(GL_TEXTURE_2D, i, iformat, level.width, level.height, 0, static_cast<GLsizei>(level.size), level.data))
+            }
+            else
+            {
+                pixels.resize(static_cast<size_t>(level.width) * level.height * 4);
+                if(!CompressedImage::decompress(format, level.data, level.width, level.height, pixels.data()))
+                {
+                    SP_PRINT_WARNING("failed to decode compressed texture level " << i);
+                    return false;
+                }
+                spCheck(glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()))
+            }
+        }
+
+        m_size              = size;
+        m_flipped           = false;
+        m_is_fbo_attachment = false;
+        m_compressed        = native;
+        m_mipmap_generated  = levels > 1;
+        m_iformat           = native ? static_cast<int>(iformat) : GL_RGBA;
+        m_format            = GL_RGBA;
+        m_api_id            = gen_unique_id();
+
+        spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1))
+        spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_repeated ? GL_REPEAT : GL_CLAMP_TO_EDGE_EXT))
+        spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_repeated ? GL_REPEAT : GL_CLAMP_TO_EDGE_EXT))
+        spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_smooth ? GL_LINEAR : GL_NEAREST))
+        if(m_mipmap_generated)
+        {
+            spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_smooth ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR))
+        }
+        else
+        {
+            spCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_smooth ? GL_LINEAR : GL_NEAREST))
+        }
+        spCheck(glFlush())
+        return true;
+    }
+
     bool Texture::loadFromFile(const char* filename, const recti& area)
     {
+        if(has_extension(filename, ".sptc"))
+        {
+            CompressedImage image;
+            return image.loadFromFile(filename) && loadFromCompressed(image);
+        }
+
         unsigned int width  = 0;
         unsigned int height = 0;
         unsigned char* data = reinterpret_cast<unsigned char*>(spHelperFileImage(filename, &width, &height, NULL, 4));
@@ -226,7 +476,11 @@ namespace sp
             return false;
         }
 
-        bool create = loadFromMemory(data, width, height, area);
+        if(premultiply_on_load)
+            premultiply(data, static_cast<size_t>(width) * height);
+
+        bool create = loadPixels(data, width, height, area);
+        m_premultiplied = create && premultiply_on_load;
 
         free(data);
         return create;
@@ -244,6 +498,12 @@ namespace sp
             return;
         }
 
+        if(m_compressed)
+        {
+            SP_PRINT_WARNING("cannot update compressed texture with uncompressed pixels");
+            return;
+        }
+
         if(pixels && m_tex_obj)
         {
             spCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, m_format, GL_UNSIGNED_BYTE, pixels))
@@ -363,6 +623,9 @@ namespace sp
     {
         if(!m_tex_obj) return false;
 
+        //compressed textures carry their own mip chain..
+        if(m_compressed) return m_mipmap_generated;
+
         if(!GL_EXT_framebuffer_object_supported)
             return false;
 
@@ -401,6 +664,16 @@ namespace sp
     {
         return m_flipped;
     }
+
+    bool Texture::isCompressed() const
+    {
+        return m_compressed;
+    }
+
+    bool Texture::isAlphaOnly() const
+    {
+        return m_format == GL_ALPHA;
+    }
     void Texture::bind(const Texture* texture, SP_Mapping mapping)
     {
         if(texture && texture->m_tex_obj)
@@ -499,131 +772,153 @@ namespace sp
         spCheck(glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0))
     }
 
-    //a pbo is a way to transfer data between buffer and textures..
-         void Texture::clearArea(int x, int y, int width, int height)
+    void Texture::clearArea(int x, int y, int width, int height)
     {
-        if(x < 0 || y < 0 || (x + width > m_size.x) || (y + height > m_size.x))
-            return;
+        clear(recti{x, y, width, height}, Color{0, 0, 0, 0});
+    }
+
+    void Texture::fill(const Color& color)
+    {
+        clear(recti{0, 0, static_cast<int>(m_size.x), static_cast<int>(m_size.y)}, color);
+    }
 
-        GLubyte* data_write = NULL;
-        GLubyte* data_read = NULL;
+    //clears a region entirely on the gpu; nothing is read back to the client..
+    void Texture::clear(const recti& area, const Color& color)
+    {
+        if(!m_tex_obj)
+            return;
 
-        if(!m_pbo_created)
+        if(m_compressed)
         {
-            createPBO();
-            m_pbo_created = true;
+            SP_PRINT_WARNING("cannot clear regions of a compressed texture");
+            return;
         }
-        spCheck(glPixelStorei(GL_UNPACK_ALIGNMENT,  4))
-        spCheck(glPixelStorei(GL_PACK_ALIGNMENT,  4))
-
-//===================================================================
-        spCheck(glBindTexture(GL_TEXTURE_2D, m_tex_obj))
-        spCheck(glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, m_pack_pbo))
-        spCheck(glGetTexImage(GL_TEXTURE_2D, 0, m_format, GL_UNSIGNED_BYTE, NULL))
-        spCheck( data_read = (GLubyte*)glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB))
 
+        recti rect = area;
+        if(!clip_area(rect, m_size))
+            return;
 
-		/*
-         *  if a buffer is bound, the last parameter is treated as an offset to that buffer's data store,
-         *  otherwise is a pointer to client's data store (unpacking treated relative to client's pointer)..
-         */
-        spCheck(glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_unpack_pbo))
-        spCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_size.x, m_size.y, m_format, GL_UNSIGNED_BYTE, NULL))
+        if(GL_ARB_clear_texture_supported)
+        {
+            const GLubyte data[4] = {color.r, color.g, color.b, color.a};
+            spCheck(glClearTexSubImage(m_tex_obj, 0, rect.left, rect.top, 0, rect.width, rect.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data))
+        }
+        else if(GL_EXT_framebuffer_object_supported)
+        {
+            GLint draw_fbo = 0;
+            spCheck(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING_EXT, &draw_fbo))
 
+            GLuint fbo = scratch_framebuffer(0);
+            spCheck(glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, fbo))
+            spCheck(glFramebufferTexture2DEXT(GL_DRAW_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, m_tex_obj, 0))
 
-        spCheck(glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_unpack_pbo))
-        spCheck(glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, m_size.x * m_size.y * 4, NULL, GL_STREAM_DRAW_ARB))
-        spCheck( data_write = (GLubyte*)glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB))
-        if(data_write && data_read)
-        {
-            int dataPitch = m_size.x * 4;
-
-
-            size_t counter  = 0;
-            size_t offset   = 0; //(y * width + x);
-            GLubyte* start  = data_write;
-            GLubyte* read   = data_read;
-            GLubyte* end    = start + m_size.x * m_size.y * 4;
-
-            /**
-             *  p   ... read_data
-             *  N   ... row number
-             *
-             *  k   defined as:
-             *
-             *  if(s >= a)
-             *      k = n * l
-             *  else
-             *      k = a / s * ceil(s * n * l / a)
-             *
-             *  n   ... number of elements in a group
-             *  l   ... number of elements in a row
-             *  s   ... size of an element in basic machine units (GLubyte)
-             *  a   ... GL_UNPACK_ALIGNMENT
-             *
-             *  advancement:
-             *  p = GL_UNPACK_SKIP_PIXELS * n + GL_UNPACK_SKIP_ROWS * k
-             *
-             */
-            for(size_t _y = 0; _y < m_size.y; _y++)
+            GLenum status;
+            spCheck(status = glCheckFramebufferStatusEXT(GL_DRAW_FRAMEBUFFER_EXT))
+            if(status == GL_FRAMEBUFFER_COMPLETE_EXT)
             {
-                for(size_t _x = 0; _x < m_size.x; _x++)
-                {
-                    if(
-                        (_x > x && _x <= x + width)
-                    &&  (_y > x && _y <= y + height)
-                       )
-                    {
-                        memset(data_write, 0, sizeof(char) * 4);
-                    }
-                    else
-                    {
-                        memcpy(data_write, data_read, sizeof(char) * 4);
-                    }
-                    data_read  += 4;
-                    data_write += 4;
-                }
+                //scissor and clear color are restored by the attribute stack..
+                spCheck(glPushAttrib(GL_SCISSOR_BIT | GL_COLOR_BUFFER_BIT))
+                spCheck(glDrawBuffer(GL_COLOR_ATTACHMENT0_EXT))
+                spCheck(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE))
+                spCheck(glEnable(GL_SCISSOR_TEST))
+                spCheck(glScissor(rect.left, rect.top, rect.width, rect.height))
+                spCheck(glClearColor(color.r / 255.f, color.g / 255.f, color.b / 255.f, color.a / 255.f))
+                spCheck(glClear(GL_COLOR_BUFFER_BIT))
+                spCheck(glPopAttrib())
             }
-
-            bool unmap = false;
-            spCheck(unmap = glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB))
-            if(!unmap)
+            else
             {
-                SP_PRINT_WARNING("failed to unmap buffer");
+                SP_PRINT_WARNING("cannot attach texture to scratch framebuffer");
             }
 
-
-            spCheck(unmap = glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB))
-            if(!unmap)
+            spCheck(glFramebufferTexture2DEXT(GL_DRAW_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, 0, 0))
+            spCheck(glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, draw_fbo))
+        }
+        else
+        {
+            //last resort, upload a block of the clear color..
+            std::vector<GLubyte> block(static_cast<size_t>(rect.width) * rect.height * 4);
+            for(size_t i = 0; i < block.size(); i += 4)
             {
-                SP_PRINT_WARNING("failed to unmap buffer");
+                block[i + 0] = color.r;
+                block[i + 1] = color.g;
+                block[i + 2] = color.b;
+                block[i + 3] = color.a;
             }
+            spCheck(glBindTexture(GL_TEXTURE_2D, m_tex_obj))
+            spCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, rect.left, rect.top, rect.width, rect.height, GL_RGBA, GL_UNSIGNED_BYTE, block.data()))
+        }
 
+        invalidateMipmap();
+    }
 
+    //copies a region of another texture into this one with a single blit..
+    void Texture::copy(const Texture& source, const recti& area, const vec2u& position)
+    {
+        if(!m_tex_obj || !source.m_tex_obj)
+        {
+            SP_PRINT_WARNING("cannot copy from or to unavailable texture object");
+            return;
+        }
 
-            spCheck(glActiveTextureARB(GL_TEXTURE0_ARB))
-            spCheck(glBindTexture(GL_TEXTURE_2D, m_tex_obj))
-            spCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_size.x, m_size.y, m_format, GL_UNSIGNED_BYTE, NULL))
+        if(source.m_tex_obj == m_tex_obj)
+        {
+            SP_PRINT_WARNING("cannot copy a texture region onto itself");
+            return;
         }
-        else
+
+        recti rect = area;
+        if(!clip_area(rect, source.m_size))
+            return;
+
+        if(position.x + rect.width  > m_size.x) rect.width  = static_cast<int>(m_size.x) - static_cast<int>(position.x);
+        if(position.y + rect.height > m_size.y) rect.height = static_cast<int>(m_size.y) - static_cast<int>(position.y);
+        if(rect.width <= 0 || rect.height <= 0)
+            return;
+
+        if(!GL_EXT_framebuffer_object_supported || !GL_EXT_framebuffer_blit_supported)
         {
-            //printf("no mapping..\n");
-            bool unmap = false;
-            spCheck(unmap = glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB))
-            if(!unmap)
-            {
-                SP_PRINT_WARNING("failed to unmap buffer");
-            }
+            SP_PRINT_WARNING("cannot copy texture regions without framebuffer blit support");
+            return;
+        }
 
-            spCheck(unmap = glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB))
-            if(!unmap)
-            {
-                SP_PRINT_WARNING("failed to unmap buffer");
-            }
+        GLint read_fbo = 0;
+        GLint draw_fbo = 0;
+        spCheck(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING_EXT, &read_fbo))
+        spCheck(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING_EXT, &draw_fbo))
+
+        spCheck(glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, scratch_framebuffer(1)))
+        spCheck(glFramebufferTexture2DEXT(GL_READ_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, source.m_tex_obj, 0))
+
+        spCheck(glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, scratch_framebuffer(0)))
+        spCheck(glFramebufferTexture2DEXT(GL_DRAW_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, m_tex_obj, 0))
+
+        GLenum src_status;
+        GLenum dst_status;
+        spCheck(src_status = glCheckFramebufferStatusEXT(GL_READ_FRAMEBUFFER_EXT))
+        spCheck(dst_status = glCheckFramebufferStatusEXT(GL_DRAW_FRAMEBUFFER_EXT))
+
+        if((src_status == GL_FRAMEBUFFER_COMPLETE_EXT)
+        && (dst_status == GL_FRAMEBUFFER_COMPLETE_EXT))
+        {
+            spCheck(glBlitFramebufferEXT(rect.left, rect.top,
+                                         rect.left + rect.width,
+                                         rect.top + rect.height,
+                                         position.x, position.y,
+                                         position.x + rect.width,
+                                         position.y + rect.height,
+                                         GL_COLOR_BUFFER_BIT,
+                                         GL_NEAREST))
+            invalidateMipmap();
         }
-        spCheck(glBindTexture(GL_TEXTURE_2D, 0))
-        spCheck(glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0))
-        spCheck(glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0))
-        spCheck(glFlush())
+        else
+        {
+            SP_PRINT_WARNING("cannot attach textures to scratch framebuffers");
+        }
+
+        spCheck(glFramebufferTexture2DEXT(GL_READ_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, 0, 0))
+        spCheck(glFramebufferTexture2DEXT(GL_DRAW_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, 0, 0))
+        spCheck(glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, read_fbo))
+        spCheck(glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, draw_fbo))
     }
 }
@@ -0,0 +1,332 @@
+#include <sp/gxsp/transform_graph.h>
+#include <algorithm>
+
+namespace sp
+{
+    TransformGraph::TransformGraph() :
+        m_reorder{false}
+    {
+    }
+
+    TransformGraph::~TransformGraph()
+    {
+    }
+
+    SPuint32 TransformGraph::slotOf(Node node) const
+    {
+        return node < m_slots.size() ? m_slots[node] : None;
+    }
+
+    bool TransformGraph::contains(Node node) const
+    {
+        return slotOf(node) != None;
+    }
+
+    size_t TransformGraph::size() const
+    {
+        return m_nodes.size();
+    }
+
+    TransformGraph::Node TransformGraph::create(Node parent)
+    {
+        SPuint32 parent_slot = None;
+        if(parent != None)
+        {
+            parent_slot = slotOf(parent);
+            if(parent_slot == None)
+            {
+                SP_PRINT_WARNING("transform node created under a missing parent");
+                return None;
+            }
+        }
+
+        Node node;
+        if(!m_free.empty())
+        {
+            node = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            node = static_cast<Node>(m_slots.size());
+            m_slots.push_back(None);
+        }
+
+        //appending keeps the parent ahead..
+        m_slots[node] = static_cast<SPuint32>(m_nodes.size());
+        m_nodes.push_back(node);
+        m_parents.push_back(parent_slot);
+        m_locals.emplace_back();
+        m_worlds.emplace_back();
+        m_dirty.push_back(1);
+        return node;
+    }
+
+    void TransformGraph::destroy(Node node)
+    {
+        SPuint32 slot = slotOf(node);
+        if(slot == None)
+            return;
+
+        if(m_reorder)
+            reorder();
+
+        //children come after their parent, one pass finds the whole subtree..
+        std::vector<SPuint8> removed(m_nodes.size(), 0);
+        removed[slot] = 1;
+        for(size_t i = slot + 1; i < m_nodes.size(); ++i)
+        {
+            if(m_parents[i] != None && removed[m_parents[i]])
+                removed[i] = 1;
+        }
+
+        m_attachments.erase(std::remove_if(m_attachments.begin(), m_attachments.end(),
+            [&](const Attachment& a){ return removed[m_slots[a.node]]; }), m_attachments.end());
+
+        //compact in order, remapping parents to their new slots..
+        std::vector<SPuint32> remap(m_nodes.size(), None);
+        size_t count = 0;
+        for(size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            if(removed[i])
+            {
+                m_slots[m_nodes[i]] = None;
+                m_free.push_back(m_nodes[i]);
+                continue;
+            }
+
+            remap[i] = static_cast<SPuint32>(count);
+            if(i != count)
+            {
+                m_nodes[count]  = m_nodes[i];
+                m_locals[count] = m_locals[i];
+                m_worlds[count] = m_worlds[i];
+                m_dirty[count]  = m_dirty[i];
+            }
+            m_parents[count] = m_parents[i] == None ? None : remap[m_parents[i]];
+            m_slots[m_nodes[count]] = static_cast<SPuint32>(count);
+            ++count;
+        }
+
+        m_nodes.resize(count);
+        m_parents.resize(count);
+        m_locals.resize(count);
+        m_worlds.resize(count);
+        m_dirty.resize(count);
+    }
+
+    bool TransformGraph::setParent(Node node, Node parent)
+    {
+        SPuint32 slot = slotOf(node);
+        if(slot == None)
+            return false;
+
+        SPuint32 parent_slot = None;
+        if(parent != None)
+        {
+            parent_slot = slotOf(parent);
+            if(parent_slot == None)
+            {
+                SP_PRINT_WARNING("transform node attached to a missing parent");
+                return false;
+            }
+
+            for(SPuint32 up = parent_slot; up != None; up = m_parents[up])
+            {
+                if(up == slot)
+                {
+                    SP_PRINT_WARNING("transform node cannot become a child of its own subtree");
+                    return false;
+                }
+            }
+        }
+
+        m_parents[slot] = parent_slot;
+        m_dirty[slot]   = 1;
+        if(parent_slot != None && parent_slot > slot)
+            m_reorder = true;
+        return true;
+    }
+
+    TransformGraph::Node TransformGraph::getParent(Node node) const
+    {
+        SPuint32 slot = slotOf(node);
+        if(slot == None || m_parents[slot] == None)
+            return None;
+        return m_nodes[m_parents[slot]];
+    }
+
+    void TransformGraph::markDirty(Node node)
+    {
+        m_dirty[m_slots[node]] = 1;
+    }
+
+    void TransformGraph::setPosition(Node node, const vec2f& position)
+    {
+        if(!contains(node))
+            return;
+        m_locals[m_slots[node]].setPosition(position);
+        markDirty(node);
+    }
+
+    void TransformGraph::setRotation(Node node, float angle)
+    {
+        if(!contains(node))
+            return;
+        m_locals[m_slots[node]].setRotation(angle);
+        markDirty(node);
+    }
+
+    void TransformGraph::setScale(Node node, const vec2f& scale)
+    {
+        if(!contains(node))
+            return;
+        m_locals[m_slots[node]].setScale(scale);
+        markDirty(node);
+    }
+
+    void TransformGraph::setOrigin(Node node, const vec2f& origin)
+    {
+        if(!contains(node))
+            return;
+        m_locals[m_slots[node]].setOrigin(origin);
+        markDirty(node);
+    }
+
+    void TransformGraph::move(Node node, const vec2f& offset)
+    {
+        if(!contains(node))
+            return;
+        m_locals[m_slots[node]].move(offset);
+        markDirty(node);
+    }
+
+    const Transformable& TransformGraph::getLocal(Node node) const
+    {
+        return m_locals[m_slots[node]];
+    }
+
+    const affine2& TransformGraph::getWorldTransform(Node node) const
+    {
+        return m_worlds[m_slots[node]];
+    }
+
+    vec2f TransformGraph::getWorldPosition(Node node) const
+    {
+        return m_worlds[m_slots[node]].transformPoint(0.f, 0.f);
+    }
+
+    void TransformGraph::attach(Node node, Drawable& drawable, const vec2f& offset)
+    {
+        if(!contains(node))
+        {
+            SP_PRINT_WARNING("drawable attached to a missing transform node");
+            return;
+        }
+
+        detach(drawable);
+        m_attachments.push_back(Attachment{drawable.getHandle(), node, offset});
+        markDirty(node);
+    }
+
+    void TransformGraph::detach(const Drawable& drawable)
+    {
+        Drawable::Handle handle = drawable.getHandle();
+        m_attachments.erase(std::remove_if(m_attachments.begin(), m_attachments.end(),
+            [&](const Attachment& a){ return a.handle.index == handle.index && a.handle.version == handle.version; }),
+            m_attachments.end());
+    }
+
+    void TransformGraph::reorder()
+    {
+        //depth first means parent first, stable keeps siblings in order..
+        size_t count = m_nodes.size();
+        std::vector<SPuint32> depth(count, 0);
+        for(size_t i = 0; i < count; ++i)
+        {
+            for(SPuint32 up = m_parents[i]; up != None; up = m_parents[up])
+                ++depth[i];
+        }
+
+        std::vector<SPuint32> order(count);
+        for(size_t i = 0; i < count; ++i)
+            order[i] = static_cast<SPuint32>(i);
+        std::stable_sort(order.begin(), order.end(), [&](SPuint32 a, SPuint32 b){ return depth[a] < depth[b]; });
+
+        std::vector<SPuint32> remap(count);
+        for(size_t i = 0; i < count; ++i)
+            remap[order[i]] = static_cast<SPuint32>(i);
+
+        std::vector<Node>           nodes(count);
+        std::vector<SPuint32>       parents(count);
+        std::vector<Transformable>  locals(count);
+        std::vector<affine2>        worlds(count);
+        std::vector<SPuint8>        dirty(count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            SPuint32 from = order[i];
+            nodes[i]   = m_nodes[from];
+            parents[i] = m_parents[from] == None ? None : remap[m_parents[from]];
+            locals[i]  = m_locals[from];
+            worlds[i]  = m_worlds[from];
+            dirty[i]   = m_dirty[from];
+            m_slots[nodes[i]] = static_cast<SPuint32>(i);
+        }
+
+        m_nodes.swap(nodes);
+        m_parents.swap(parents);
+        m_locals.swap(locals);
+        m_worlds.swap(worlds);
+        m_dirty.swap(dirty);
+        m_reorder = false;
+    }
+
+    void TransformGraph::update()
+    {
+        if(m_reorder)
+            reorder();
+
+        //a parent is always resolved before its children..
+        size_t count = m_nodes.size();
+        for(size_t i = 0; i < count; ++i)
+        {
+            SPuint32 parent = m_parents[i];
+            if(parent != None && m_dirty[parent])
+                m_dirty[i] = 1;
+            if(!m_dirty[i])
+                continue;
+
+            if(parent == None)
+                m_worlds[i] = m_locals[i].getTransform();
+            else
+                m_worlds[i] = m_worlds[parent] * m_locals[i].getTransform();
+        }
+
+        //hand the new translations straight to the states records, the
+        //renderer picks them up on its next refresh..
+        for(size_t i = 0; i < m_attachments.size();)
+        {
+            const Attachment& attachment = m_attachments[i];
+            SPuint32 slot = m_slots[attachment.node];
+            if(!m_dirty[slot])
+            {
+                ++i;
+                continue;
+            }
+
+            Drawable::DrawableStates* states = Drawable::lookup(attachment.handle);
+            if(!states)
+            {
+                m_attachments[i] = m_attachments.back();
+                m_attachments.pop_back();
+                continue;
+            }
+
+            states->position = m_worlds[slot].transformPoint(attachment.offset);
+            states->moved    = true;
+            ++i;
+        }
+
+        std::fill(m_dirty.begin(), m_dirty.end(), 0);
+    }
+}
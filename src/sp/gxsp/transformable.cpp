@@ -8,9 +8,9 @@ namespace sp
         m_position      {0, 0},
         m_rotation      {0},
         m_scale         {1, 1},
-        m_matrix        {},
+        m_transform     {},
         m_update_mat    {true},
-        m_inv_matrix    {},
+        m_inv_transform {},
         m_update_inv_mat{true}
     {
     }
@@ -107,7 +107,7 @@ namespace sp
         setScale(m_scale.x * scale.x, m_scale.y * scale.y);
     }
 
-    const mat& Transformable::getMatrix() const
+    const affine2& Transformable::getTransform() const
     {
         if(m_update_mat)
         {
@@ -121,23 +121,31 @@ namespace sp
             float tx    = -m_origin.x * sxc - m_origin.y * sys + m_position.x;
             float ty    =  m_origin.x * sxs - m_origin.y * syc + m_position.y;
 
-            m_matrix = mat(sxc, sys, tx,
-                           -sxs, syc, ty,
-                           0.f, 0.f, 1.f);
+            m_transform = affine2{sxc, -sxs, sys, syc, tx, ty};
             m_update_mat = false;
         }
 
-        return m_matrix;
+        return m_transform;
     }
 
-    const mat& Transformable::getInverseMatrix() const
+    const affine2& Transformable::getInverseTransform() const
     {
         if(m_update_inv_mat)
         {
+            m_inv_transform = getTransform().inverse();
             m_update_inv_mat = false;
-            m_inv_matrix = mat(!m_matrix);
         }
 
-        return m_inv_matrix;
+        return m_inv_transform;
+    }
+
+    mat Transformable::getMatrix() const
+    {
+        return getTransform().toMat();
+    }
+
+    mat Transformable::getInverseMatrix() const
+    {
+        return getInverseTransform().toMat();
     }
 }
@@ -127,15 +127,16 @@ namespace sp
     {
         float scale_range = m_range / BASE_RADIUS;
         m_transformable.setPosition(m_position);
-        const_cast<mat&>(m_transformable.getMatrix()).scale(scale_range, scale_range, BASE_RADIUS, BASE_RADIUS);
-        return m_transformable.getMatrix().transformRect(Drawable::getGlobalBounds());
+        mat matrix = m_transformable.getMatrix();
+        matrix.scale(scale_range, scale_range, BASE_RADIUS, BASE_RADIUS);
+        return matrix.transformRect(Drawable::getGlobalBounds());
     }
     void RadialLight::draw()
     {
         //printf("custom draw..\n");
 
-        const mat& matrix = m_transformable.getMatrix();
-        const_cast<mat&>(m_transformable.getMatrix()).scale(m_range/BASE_RADIUS, m_range/BASE_RADIUS, BASE_RADIUS, BASE_RADIUS);
+        mat matrix = m_transformable.getMatrix();
+        matrix.scale(m_range/BASE_RADIUS, m_range/BASE_RADIUS, BASE_RADIUS, BASE_RADIUS);
         m_draw_states.matrix  = matrix;
         m_draw_states.texture = &fade_texture;
         m_draw_states.blend_mode = BlendAdd;
@@ -147,7 +148,8 @@ namespace sp
         float scale_range = m_range / BASE_RADIUS;
 
         m_transformable.setPosition(m_position);
-        const_cast<mat&>(m_transformable.getMatrix()).scale(scale_range, scale_range, BASE_RADIUS, BASE_RADIUS);
+        mat matrix = m_transformable.getMatrix();
+        matrix.scale(scale_range, scale_range, BASE_RADIUS, BASE_RADIUS);
         std::vector<sp::Line> rays;
         rays.reserve(2 + std::distance(begin, end) * 2 * 3);
 
@@ -221,7 +223,7 @@ namespace sp
             });
         }
 
-        mat tr_i = !m_transformable.getMatrix();
+        mat tr_i = !matrix;
 
         std::vector<vec2f> points;
         points.reserve(rays.size());
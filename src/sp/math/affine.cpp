@@ -0,0 +1,126 @@
+#include <sp/math/affine.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SP_AFFINE_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace sp
+{
+    static_assert(sizeof(vec2f) == 2 * sizeof(float), "vec2f must be two packed floats");
+    static_assert(sizeof(rectf) == 4 * sizeof(float), "rectf must be four packed floats");
+
+    affine2 affine2::rotation(float angle)
+    {
+        float radians = -angle * 3.141592654f / 180.f;
+        float cos = std::cos(radians);
+        float sin = std::sin(radians);
+        return affine2{cos, -sin, sin, cos, 0.f, 0.f};
+    }
+
+    rectf affine2::transformRect(const rectf& area) const
+    {
+        rectf bounds;
+        transformRects(*this, &area, &bounds, 1);
+        return bounds;
+    }
+
+    void affine2::toGL(float out[16]) const
+    {
+        out[0]  = a;   out[1]  = b;   out[2]  = 0.f; out[3]  = 0.f;
+        out[4]  = c;   out[5]  = d;   out[6]  = 0.f; out[7]  = 0.f;
+        out[8]  = 0.f; out[9]  = 0.f; out[10] = 1.f; out[11] = 0.f;
+        out[12] = tx;  out[13] = ty;  out[14] = 0.f; out[15] = 1.f;
+    }
+
+    mat affine2::toMat() const
+    {
+        return mat(a,   c,   tx,
+                   b,   d,   ty,
+                   0.f, 0.f, 1.f);
+    }
+
+    void transformPoints(const affine2& m, const vec2f* points, vec2f* out, size_t count)
+    {
+        size_t i = 0;
+#ifdef SP_AFFINE_SSE2
+        //two points per register: x0 y0 x1 y1..
+        const __m128 ab = _mm_setr_ps(m.a,  m.b,  m.a,  m.b);
+        const __m128 cd = _mm_setr_ps(m.c,  m.d,  m.c,  m.d);
+        const __m128 t  = _mm_setr_ps(m.tx, m.ty, m.tx, m.ty);
+        for(; i + 2 <= count; i += 2)
+        {
+            __m128 p  = _mm_loadu_ps(&points[i].x);
+            __m128 xs = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+            __m128 ys = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+            __m128 r  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, ab), _mm_mul_ps(ys, cd)), t);
+            _mm_storeu_ps(&out[i].x, r);
+        }
+#endif
+        for(; i < count; ++i)
+            out[i] = m.transformPoint(points[i]);
+    }
+
+    void transformRects(const affine2& m, const rectf* rects, rectf* out, size_t count)
+    {
+#ifdef SP_AFFINE_SSE2
+        //the four corners of a rect in one register per axis..
+        const __m128 a  = _mm_set1_ps(m.a);
+        const __m128 b  = _mm_set1_ps(m.b);
+        const __m128 c  = _mm_set1_ps(m.c);
+        const __m128 d  = _mm_set1_ps(m.d);
+        const __m128 tx = _mm_set1_ps(m.tx);
+        const __m128 ty = _mm_set1_ps(m.ty);
+        for(size_t i = 0; i < count; ++i)
+        {
+            const rectf& area = rects[i];
+            float right  = area.left + area.width;
+            float bottom = area.top  + area.height;
+            __m128 xs = _mm_setr_ps(area.left, area.left, right, right);
+            __m128 ys = _mm_setr_ps(area.top,  bottom,    area.top, bottom);
+            __m128 px = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, xs), _mm_mul_ps(c, ys)), tx);
+            __m128 py = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b, xs), _mm_mul_ps(d, ys)), ty);
+
+            __m128 min_x = _mm_min_ps(px, _mm_shuffle_ps(px, px, _MM_SHUFFLE(1, 0, 3, 2)));
+            __m128 max_x = _mm_max_ps(px, _mm_shuffle_ps(px, px, _MM_SHUFFLE(1, 0, 3, 2)));
+            __m128 min_y = _mm_min_ps(py, _mm_shuffle_ps(py, py, _MM_SHUFFLE(1, 0, 3, 2)));
+            __m128 max_y = _mm_max_ps(py, _mm_shuffle_ps(py, py, _MM_SHUFFLE(1, 0, 3, 2)));
+            min_x = _mm_min_ss(min_x, _mm_shuffle_ps(min_x, min_x, _MM_SHUFFLE(2, 3, 0, 1)));
+            max_x = _mm_max_ss(max_x, _mm_shuffle_ps(max_x, max_x, _MM_SHUFFLE(2, 3, 0, 1)));
+            min_y = _mm_min_ss(min_y, _mm_shuffle_ps(min_y, min_y, _MM_SHUFFLE(2, 3, 0, 1)));
+            max_y = _mm_max_ss(max_y, _mm_shuffle_ps(max_y, max_y, _MM_SHUFFLE(2, 3, 0, 1)));
+
+            float left = _mm_cvtss_f32(min_x);
+            float top  = _mm_cvtss_f32(min_y);
+            out[i] = rectf{left, top, _mm_cvtss_f32(max_x) - left, _mm_cvtss_f32(max_y) - top};
+        }
+#else
+        for(size_t i = 0; i < count; ++i)
+        {
+            const rectf& area = rects[i];
+            const vec2f points[] =
+            {
+                m.transformPoint(area.left,              area.top),
+                m.transformPoint(area.left,              area.top + area.height),
+                m.transformPoint(area.left + area.width, area.top),
+                m.transformPoint(area.left + area.width, area.top + area.height)
+            };
+
+            float left   = points[0].x;
+            float top    = points[0].y;
+            float right  = points[0].x;
+            float bottom = points[0].y;
+            for(int p = 1; p < 4; ++p)
+            {
+                left   = std::min(left,   points[p].x);
+                right  = std::max(right,  points[p].x);
+                top    = std::min(top,    points[p].y);
+                bottom = std::max(bottom, points[p].y);
+            }
+            out[i] = rectf{left, top, right - left, bottom - top};
+        }
+#endif
+    }
+}
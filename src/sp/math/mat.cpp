@@ -100,7 +100,7 @@ namespace sp
             transformVertex(area.left, area.top),
             transformVertex(area.left, area.top + area.height),
             transformVertex(area.left + area.width, area.top),
-            transformVertex(area.left + area.width, area.top + area.top)
+            transformVertex(area.left + area.width, area.top + area.height)
 	    };
 
 	    float left      = points[0].x;
@@ -49,9 +49,11 @@ namespace sp
         static const void* font = NULL;
         if(!font)
         {
-            font = loadDefaultFont();
+            size_t size = 0;
+            font = loadDefaultFont(&size);
             default_font = Font::create();
-            default_font->loadFromMemory(font);
+            default_font->loadFromMemory(font, size);
+            default_font->setBakedGlyphs(loadDefaultBakedFont());
         }
 
         return default_font;
@@ -627,6 +629,9 @@ namespace sp
                 glfwSwapBuffers(window);
             }
 
+            //immediate draws live for one tick, whether it got rendered or not..
+            m_renderer.releaseImmediate();
+
             float currentFrame = (float) glfwGetTime();
             deltaTime = currentFrame - lastFrame;
             lastFrame = currentFrame;
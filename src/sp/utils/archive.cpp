@@ -0,0 +1,551 @@
+#include <sp/utils/archive.h>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+#if defined(SP_SYSTEM_WINDOWS)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace sp
+{
+    namespace
+    {
+        const char      archive_magic[4]    = {'S', 'P', 'A', 'K'};
+        const SPuint32  archive_version     = 1;
+        const SPuint32  blob_alignment      = 64;
+        const SPuint32  entry_compressed    = 1u << 0;
+
+        const unsigned int  min_match       = 4;
+        const unsigned int  last_literals   = 5;
+        const unsigned int  match_limit     = 12;
+        const unsigned int  hash_bits       = 16;
+
+        struct Header
+        {
+            char        magic[4];
+            SPuint32    version;
+            SPuint32    count;
+            SPuint32    alignment;
+            SPuint64    toc_offset;
+            SPuint64    names_offset;
+        };
+        static_assert(sizeof(Header) == 32, "archive header must be packed");
+
+        SPuint32 read32(const SPuint8* p)
+        {
+            SPuint32 value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        SPuint32 hash_sequence(SPuint32 sequence)
+        {
+            return (sequence * 2654435761u) >> (32 - hash_bits);
+        }
+
+        void write_length(std::vector<SPuint8>& out, size_t length)
+        {
+            while(length >= 255)
+            {
+                out.push_back(255);
+                length -= 255;
+            }
+            out.push_back(static_cast<SPuint8>(length));
+        }
+
+        //names are matched case-sensitively with forward slashes..
+        std::string normalize(const char* name)
+        {
+            std::string result(name);
+            std::replace(result.begin(), result.end(), '\\', '/');
+            if(!result.empty() && result[0] == '/')
+                result.erase(0, 1);
+            return result;
+        }
+    }
+
+    struct Archive::Entry
+    {
+        SPuint64    hash;
+        SPuint64    offset;
+        SPuint32    stored_size;
+        SPuint32    size;
+        SPuint32    flags;
+        SPuint32    name;
+    };
+
+    Archive::Archive() :
+        m_data      {nullptr},
+        m_size      {0},
+        m_entries   {nullptr},
+        m_count     {0},
+        m_names     {nullptr},
+        m_names_size{0},
+        m_file      {nullptr},
+        m_mapping   {nullptr}
+    {
+    }
+
+    Archive::~Archive()
+    {
+        close();
+    }
+
+    bool Archive::open(const char* path)
+    {
+        close();
+
+#if defined(SP_SYSTEM_WINDOWS)
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+        if(file == INVALID_HANDLE_VALUE)
+        {
+            SP_PRINT_WARNING("cannot open archive " << path);
+            return false;
+        }
+
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            SP_PRINT_WARNING("cannot map empty archive " << path);
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if(!data)
+        {
+            SP_PRINT_WARNING("cannot map archive " << path);
+            if(mapping) CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file    = file;
+        m_mapping = mapping;
+        m_size    = static_cast<size_t>(size.QuadPart);
+#else
+        int file = ::open(path, O_RDONLY);
+        if(file < 0)
+        {
+            SP_PRINT_WARNING("cannot open archive " << path);
+            return false;
+        }
+
+        struct stat info;
+        if(fstat(file, &info) != 0 || info.st_size == 0)
+        {
+            SP_PRINT_WARNING("cannot map empty archive " << path);
+            ::close(file);
+            return false;
+        }
+
+        void* data = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if(data == MAP_FAILED)
+        {
+            SP_PRINT_WARNING("cannot map archive " << path);
+            return false;
+        }
+
+        m_mapping = data;
+        m_size    = static_cast<size_t>(info.st_size);
+#endif
+        m_data = reinterpret_cast<const SPuint8*>(data);
+
+        Header header;
+        if(m_size < sizeof(Header))
+        {
+            SP_PRINT_WARNING("archive " << path << " is truncated");
+            close();
+            return false;
+        }
+        std::memcpy(&header, m_data, sizeof(Header));
+
+        if(std::memcmp(header.magic, archive_magic, 4) != 0 || header.version != archive_version)
+        {
+            SP_PRINT_WARNING(path << " is not a supported archive");
+            close();
+            return false;
+        }
+
+        if(header.toc_offset + static_cast<SPuint64>(header.count) * sizeof(Entry) > m_size
+        || header.names_offset > m_size
+        || header.toc_offset % alignof(Entry) != 0)
+        {
+            SP_PRINT_WARNING("archive " << path << " has a malformed table of contents");
+            close();
+            return false;
+        }
+
+        m_entries    = reinterpret_cast<const Entry*>(m_data + header.toc_offset);
+        m_count      = header.count;
+        m_names      = reinterpret_cast<const char*>(m_data + header.names_offset);
+        m_names_size = m_size - static_cast<size_t>(header.names_offset);
+
+        for(SPuint32 i = 0; i < m_count; ++i)
+        {
+            const Entry& entry = m_entries[i];
+            if(entry.offset > m_size || entry.stored_size > m_size - entry.offset || entry.name >= m_names_size)
+            {
+                SP_PRINT_WARNING("archive " << path << " has an entry out of range");
+                close();
+                return false;
+            }
+
+            //stored entries are handed out with their size, straight from the mapping..
+            if(!(entry.flags & entry_compressed) && entry.size != entry.stored_size)
+            {
+                SP_PRINT_WARNING("archive " << path << " has a stored entry of mismatching size");
+                close();
+                return false;
+            }
+        }
+
+#if !defined(SP_SYSTEM_WINDOWS)
+        //the table of contents is hit on every lookup, blobs only once..
+        SPuint64 page_mask = ~static_cast<SPuint64>(sysconf(_SC_PAGESIZE) - 1);
+        madvise(const_cast<SPuint8*>(m_data) + (header.toc_offset & page_mask),
+                static_cast<size_t>(m_size - (header.toc_offset & page_mask)), MADV_WILLNEED);
+#endif
+        return true;
+    }
+
+    void Archive::close()
+    {
+        m_decoded.clear();
+
+#if defined(SP_SYSTEM_WINDOWS)
+        if(m_data)    UnmapViewOfFile(m_data);
+        if(m_mapping) CloseHandle(m_mapping);
+        if(m_file)    CloseHandle(m_file);
+#else
+        if(m_mapping) munmap(m_mapping, m_size);
+#endif
+
+        m_data      = nullptr;
+        m_size      = 0;
+        m_entries   = nullptr;
+        m_count     = 0;
+        m_names     = nullptr;
+        m_names_size= 0;
+        m_file      = nullptr;
+        m_mapping   = nullptr;
+    }
+
+    bool Archive::isOpen() const
+    {
+        return m_data != nullptr;
+    }
+
+    size_t Archive::getEntryCount() const
+    {
+        return m_count;
+    }
+
+    //fnv-1a..
+    SPuint64 Archive::hash(const char* name)
+    {
+        SPuint64 value = 14695981039346656037ull;
+        for(const char* c = name; *c; ++c)
+        {
+            value ^= static_cast<SPuint8>(*c == '\\' ? '/' : *c);
+            value *= 1099511628211ull;
+        }
+        return value;
+    }
+
+    const Archive::Entry* Archive::lookup(const char* name) const
+    {
+        if(!m_entries || !name)
+            return nullptr;
+
+        std::string key  = normalize(name);
+        SPuint64    code = hash(key.c_str());
+
+        const Entry* end = m_entries + m_count;
+        const Entry* it  = std::lower_bound(m_entries, end, code,
+            [](const Entry& entry, SPuint64 value) { return entry.hash < value; });
+
+        for(; it != end && it->hash == code; ++it)
+        {
+            const char* candidate = m_names + it->name;
+            if(std::strncmp(candidate, key.c_str(), m_names_size - it->name) == 0)
+                return it;
+        }
+        return nullptr;
+    }
+
+    bool Archive::contains(const char* name) const
+    {
+        return lookup(name) != nullptr;
+    }
+
+    Archive::View Archive::find(const char* name) const
+    {
+        View view;
+        const Entry* entry = lookup(name);
+        if(!entry)
+            return view;
+
+        const SPuint8* blob = m_data + entry->offset;
+        if(!(entry->flags & entry_compressed))
+        {
+            view.data = blob;
+            view.size = entry->size;
+            return view;
+        }
+
+        auto it = m_decoded.find(entry);
+        if(it == m_decoded.end())
+        {
+            std::vector<SPuint8> decoded(static_cast<size_t>(entry->size));
+            if(!decompressBlock(blob, entry->stored_size, decoded.data(), entry->size))
+            {
+                SP_PRINT_WARNING("archive entry " << name << " is corrupted");
+                return view;
+            }
+            it = m_decoded.emplace(entry, std::move(decoded)).first;
+        }
+
+        view.data = it->second.data();
+        view.size = entry->size;
+        return view;
+    }
+
+    size_t Archive::compressBound(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    //greedy single-pass lz4 block compressor..
+    size_t Archive::compressBlock(const SPuint8* src, size_t size, SPuint8* dst, size_t capacity)
+    {
+        std::vector<SPuint8> out;
+        out.reserve(compressBound(size));
+
+        std::vector<SPuint32> table(static_cast<size_t>(1) << hash_bits, 0xffffffffu);
+        size_t anchor = 0;
+        size_t ip     = 0;
+
+        auto emit = [&](size_t literal_end, size_t match_length, size_t offset)
+        {
+            size_t literals = literal_end - anchor;
+            SPuint8 token = static_cast<SPuint8>(std::min<size_t>(literals, 15) << 4);
+            if(match_length)
+                token |= static_cast<SPuint8>(std::min<size_t>(match_length - min_match, 15));
+            out.push_back(token);
+
+            if(literals >= 15)
+                write_length(out, literals - 15);
+            out.insert(out.end(), src + anchor, src + literal_end);
+
+            if(match_length)
+            {
+                out.push_back(static_cast<SPuint8>(offset));
+                out.push_back(static_cast<SPuint8>(offset >> 8));
+                if(match_length - min_match >= 15)
+                    write_length(out, match_length - min_match - 15);
+            }
+        };
+
+        if(size > match_limit)
+        {
+            const size_t limit = size - match_limit;
+            while(ip < limit)
+            {
+                SPuint32 sequence = read32(src + ip);
+                SPuint32 slot     = hash_sequence(sequence);
+                size_t   ref      = table[slot];
+                table[slot]       = static_cast<SPuint32>(ip);
+
+                if(ref == 0xffffffffu || ip - ref > 0xffff || read32(src + ref) != sequence)
+                {
+                    ip++;
+                    continue;
+                }
+
+                size_t length = min_match;
+                while(ip + length < size - last_literals && src[ref + length] == src[ip + length])
+                    length++;
+
+                emit(ip, length, ip - ref);
+                ip    += length;
+                anchor = ip;
+            }
+        }
+
+        emit(size, 0, 0);
+
+        if(out.size() > capacity)
+            return 0;
+        std::memcpy(dst, out.data(), out.size());
+        return out.size();
+    }
+
+    bool Archive::decompressBlock(const SPuint8* src, size_t size, SPuint8* dst, size_t raw_size)
+    {
+        const SPuint8* ip  = src;
+        const SPuint8* end = src + size;
+        size_t         op  = 0;
+
+        while(ip < end)
+        {
+            SPuint8 token = *ip++;
+
+            size_t literals = token >> 4;
+            if(literals == 15)
+            {
+                SPuint8 byte;
+                do
+                {
+                    if(ip >= end) return false;
+                    byte = *ip++;
+                    literals += byte;
+                }
+                while(byte == 255);
+            }
+
+            if(literals > static_cast<size_t>(end - ip) || op + literals > raw_size)
+                return false;
+            std::memcpy(dst + op, ip, literals);
+            ip += literals;
+            op += literals;
+
+            //the last sequence carries literals only..
+            if(ip >= end)
+                break;
+
+            if(end - ip < 2)
+                return false;
+            size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            if(!offset || offset > op)
+                return false;
+
+            size_t length = token & 15;
+            if(length == 15)
+            {
+                SPuint8 byte;
+                do
+                {
+                    if(ip >= end) return false;
+                    byte = *ip++;
+                    length += byte;
+                }
+                while(byte == 255);
+            }
+            length += min_match;
+
+            if(op + length > raw_size)
+                return false;
+
+            //matches may overlap their own output..
+            for(size_t i = 0; i < length; ++i, ++op)
+                dst[op] = dst[op - offset];
+        }
+
+        return op == raw_size;
+    }
+
+    bool Archive::build(const char* path, std::vector<Source>& sources, bool compress)
+    {
+        for(auto& source : sources)
+            source.name = normalize(source.name.c_str());
+
+        std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b)
+        {
+            SPuint64 ha = hash(a.name.c_str());
+            SPuint64 hb = hash(b.name.c_str());
+            return ha != hb ? ha < hb : a.name < b.name;
+        });
+
+        for(size_t i = 1; i < sources.size(); ++i)
+        {
+            if(sources[i].name == sources[i - 1].name)
+            {
+                SP_PRINT_WARNING("duplicate archive entry " << sources[i].name);
+                return false;
+            }
+        }
+
+        std::FILE* file = std::fopen(path, "wb");
+        if(!file)
+        {
+            SP_PRINT_WARNING("cannot create archive " << path);
+            return false;
+        }
+
+        std::vector<Entry>  entries(sources.size());
+        std::string         names;
+        std::vector<SPuint8> scratch;
+        const SPuint8       padding[blob_alignment] = {};
+
+        SPuint64 offset = sizeof(Header);
+        bool ok = std::fwrite(padding, 1, sizeof(Header), file) == sizeof(Header);
+
+        for(size_t i = 0; ok && i < sources.size(); ++i)
+        {
+            const Source& source = sources[i];
+            Entry& entry = entries[i];
+
+            SPuint64 aligned = (offset + blob_alignment - 1) & ~static_cast<SPuint64>(blob_alignment - 1);
+            ok = ok && std::fwrite(padding, 1, static_cast<size_t>(aligned - offset), file) == aligned - offset;
+            offset = aligned;
+
+            const SPuint8* blob = source.data.data();
+            size_t stored = source.data.size();
+            entry.flags = 0;
+
+            if(compress && stored > match_limit)
+            {
+                scratch.resize(compressBound(stored));
+                size_t packed = compressBlock(blob, stored, scratch.data(), scratch.size());
+
+                //keep it stored unless compression saves at least an eighth..
+                if(packed && packed < stored - stored / 8)
+                {
+                    blob   = scratch.data();
+                    stored = packed;
+                    entry.flags |= entry_compressed;
+                }
+            }
+
+            entry.hash        = hash(source.name.c_str());
+            entry.offset      = offset;
+            entry.stored_size = static_cast<SPuint32>(stored);
+            entry.size        = static_cast<SPuint32>(source.data.size());
+            entry.name        = static_cast<SPuint32>(names.size());
+            names.append(source.name);
+            names.push_back('\0');
+
+            ok = ok && std::fwrite(blob, 1, stored, file) == stored;
+            offset += stored;
+        }
+
+        Header header;
+        std::memcpy(header.magic, archive_magic, 4);
+        header.version      = archive_version;
+        header.count        = static_cast<SPuint32>(entries.size());
+        header.alignment    = blob_alignment;
+        header.toc_offset   = (offset + alignof(Entry) - 1) & ~static_cast<SPuint64>(alignof(Entry) - 1);
+        header.names_offset = header.toc_offset + entries.size() * sizeof(Entry);
+
+        ok = ok && std::fwrite(padding, 1, static_cast<size_t>(header.toc_offset - offset), file) == header.toc_offset - offset;
+        ok = ok && std::fwrite(entries.data(), sizeof(Entry), entries.size(), file) == entries.size();
+        ok = ok && std::fwrite(names.data(), 1, names.size(), file) == names.size();
+        ok = ok && std::fseek(file, 0, SEEK_SET) == 0;
+        ok = ok && std::fwrite(&header, sizeof(Header), 1, file) == 1;
+        ok = (std::fclose(file) == 0) && ok;
+
+        if(!ok)
+            SP_PRINT_WARNING("failed to write archive " << path);
+        return ok;
+    }
+}
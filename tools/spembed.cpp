@@ -0,0 +1,196 @@
+/**
+ *  spembed - embeds a truetype font into a c++ header..
+ *
+ *  the raw font bytes are written as an array, so nothing has to be decoded
+ *  at runtime. for every --sizes entry the printable ascii range is rasterized
+ *  the same way Font does, and written as an SP_Baked_Font along with its
+ *  metrics; hand it to Font::setBakedGlyphs to skip rasterizing those glyphs.
+ *
+ *  build:
+ *      c++ -std=c++14 -Iinclude tools/spembed.cpp -o spembed
+ *
+ *  usage:
+ *      spembed [--name identifier] [--sizes 16,24,30] input.ttf output.h
+ *
+ *  include/sp/gxsp/default_font.h is generated with:
+ *      spembed --name default_font --sizes 16,24,30 arial.ttf include/sp/gxsp/default_font.h
+ */
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_STATIC
+#include <stb/stb_truetype.h>
+
+namespace
+{
+    const unsigned int baked_first = 32;
+    const unsigned int baked_last  = 126;
+
+    struct Glyph
+    {
+        float           advance;
+        int             lsb;
+        int             x0, y0, x1, y1;
+        size_t          offset;
+    };
+
+    void usage()
+    {
+        std::fprintf(stderr, "usage: spembed [--name identifier] [--sizes 16,24,30] input.ttf output.h\n");
+    }
+
+    bool parse_sizes(const char* list, std::vector<unsigned int>& sizes)
+    {
+        while(*list)
+        {
+            char* end = nullptr;
+            unsigned long size = std::strtoul(list, &end, 10);
+            if(end == list || !size || size > 512)
+                return false;
+
+            sizes.push_back(static_cast<unsigned int>(size));
+            list = *end == ',' ? end + 1 : end;
+        }
+        return !sizes.empty();
+    }
+
+    void write_bytes(FILE* file, const unsigned char* data, size_t size)
+    {
+        for(size_t i = 0; i < size; ++i)
+        {
+            std::fprintf(file, "%u,", data[i]);
+            if(i % 32 == 31)
+                std::fputc('\n', file);
+        }
+        std::fputc('\n', file);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string name = "embedded_font";
+    std::vector<unsigned int> sizes;
+    const char* input  = nullptr;
+    const char* output = nullptr;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if(!std::strcmp(argv[i], "--name") && i + 1 < argc)
+            name = argv[++i];
+        else if(!std::strcmp(argv[i], "--sizes") && i + 1 < argc)
+        {
+            if(!parse_sizes(argv[++i], sizes))
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if(!input)
+            input = argv[i];
+        else if(!output)
+            output = argv[i];
+    }
+
+    if(!input || !output)
+    {
+        usage();
+        return 1;
+    }
+
+    std::ifstream stream(input, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    stbtt_fontinfo font;
+    if(data.empty() || !stbtt_InitFont(&font, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0)))
+    {
+        std::fprintf(stderr, "spembed: %s is not a truetype font\n", input);
+        return 1;
+    }
+
+    //metrics and bitmaps exactly as Font::createCharacter and Font::getGlyph make them..
+    std::vector<unsigned char> pixels;
+    std::vector<std::vector<Glyph>> baked(sizes.size());
+    for(size_t s = 0; s < sizes.size(); ++s)
+    {
+        float scale = stbtt_ScaleForPixelHeight(&font, static_cast<float>(sizes[s]));
+        for(unsigned int codepoint = baked_first; codepoint <= baked_last; ++codepoint)
+        {
+            int glyph = stbtt_FindGlyphIndex(&font, codepoint);
+            int advance, lsb;
+            Glyph g;
+            stbtt_GetGlyphHMetrics(&font, glyph, &advance, &lsb);
+            stbtt_GetGlyphBitmapBox(&font, glyph, scale, scale, &g.x0, &g.y0, &g.x1, &g.y1);
+            g.advance   = static_cast<float>(advance) * scale;
+            g.lsb       = lsb;
+            g.offset    = pixels.size();
+
+            int width  = g.x1 - g.x0;
+            int height = g.y1 - g.y0;
+            if(width > 0 && height > 0)
+            {
+                pixels.resize(pixels.size() + static_cast<size_t>(width) * height, 0);
+                stbtt_MakeGlyphBitmap(&font, pixels.data() + g.offset, width, height, width, scale, scale, glyph);
+            }
+            baked[s].push_back(g);
+        }
+    }
+
+    FILE* file = std::fopen(output, "wb");
+    if(!file)
+    {
+        std::fprintf(stderr, "spembed: cannot write %s\n", output);
+        return 1;
+    }
+
+    std::string guard = "SP_EMBED_" + name;
+    for(char& c : guard)
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+    std::fprintf(file, "//generated by tools/spembed.cpp, do not edit..\n");
+    std::fprintf(file, "#ifndef %s\n#define %s\n", guard.c_str(), guard.c_str());
+    std::fprintf(file, "#include <sp/sp.h>\n#include <sp/gxsp/font.h>\n\n");
+
+    std::fprintf(file, "static const size_t %s_size = %zu;\n", name.c_str(), data.size());
+    std::fprintf(file, "alignas(4) static const SPuint8 %s_data[] =\n{\n", name.c_str());
+    write_bytes(file, data.data(), data.size());
+    std::fprintf(file, "};\n");
+
+    if(!sizes.empty())
+    {
+        std::fprintf(file, "\nstatic const SPuint8 %s_pixels[] =\n{\n", name.c_str());
+        write_bytes(file, pixels.data(), pixels.size());
+        std::fprintf(file, "};\n");
+
+        for(size_t s = 0; s < sizes.size(); ++s)
+        {
+            std::fprintf(file, "\nstatic const sp::SP_Baked_Glyph %s_glyphs_%u[] =\n{\n", name.c_str(), sizes[s]);
+            for(const Glyph& g : baked[s])
+            {
+                std::fprintf(file, "{%.9g,%d,%d,%d,%d,%d,%zu},\n", g.advance, g.lsb, g.x0, g.y0, g.x1, g.y1, g.offset);
+            }
+            std::fprintf(file, "};\n");
+        }
+
+        std::fprintf(file, "\nstatic const sp::SP_Baked_Size %s_sizes[] =\n{\n", name.c_str());
+        for(size_t s = 0; s < sizes.size(); ++s)
+        {
+            std::fprintf(file, "{%u,%u,%u,%s_glyphs_%u},\n", sizes[s], baked_first, baked_last - baked_first + 1, name.c_str(), sizes[s]);
+        }
+        std::fprintf(file, "};\n");
+
+        std::fprintf(file, "\nstatic const sp::SP_Baked_Font %s_baked = {%s_sizes, %zu, %s_pixels};\n",
+                     name.c_str(), name.c_str(), sizes.size(), name.c_str());
+    }
+
+    std::fprintf(file, "\n#endif // %s\n", guard.c_str());
+    std::fclose(file);
+
+    std::printf("%s: %zu font bytes, %zu sizes, %zu baked bytes\n", output, data.size(), sizes.size(), pixels.size());
+    return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ *  sppack - builds an asset archive from a directory..
+ *
+ *  every regular file below the directory is stored under its relative path
+ *  (forward slashes), compressed unless --store is given or it does not pay off.
+ *
+ *  build:
+ *      c++ -std=c++17 -Iinclude tools/sppack.cpp -o sppack -lsp
+ *
+ *  usage:
+ *      sppack [--store] directory output.spak
+ */
+#include <sp/utils/archive.h>
+#include <filesystem>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv)
+{
+    bool compress = true;
+    const char* directory = nullptr;
+    const char* output    = nullptr;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if(!std::strcmp(argv[i], "--store"))
+            compress = false;
+        else if(!directory)
+            directory = argv[i];
+        else if(!output)
+            output = argv[i];
+    }
+
+    if(!directory || !output)
+    {
+        std::fprintf(stderr, "usage: sppack [--store] directory output.spak\n");
+        return 1;
+    }
+
+    std::error_code error;
+    std::vector<sp::Archive::Source> sources;
+    size_t total = 0;
+
+    for(const auto& item : fs::recursive_directory_iterator(directory, error))
+    {
+        if(!item.is_regular_file())
+            continue;
+
+        std::ifstream file(item.path(), std::ios::binary);
+        if(!file)
+        {
+            std::fprintf(stderr, "sppack: cannot read %s\n", item.path().string().c_str());
+            return 1;
+        }
+
+        sp::Archive::Source source;
+        source.name = fs::relative(item.path(), directory).generic_string();
+        source.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        total += source.data.size();
+        sources.push_back(std::move(source));
+    }
+
+    if(error)
+    {
+        std::fprintf(stderr, "sppack: cannot walk %s (%s)\n", directory, error.message().c_str());
+        return 1;
+    }
+
+    if(!sp::Archive::build(output, sources, compress))
+        return 1;
+
+    std::printf("%s: %zu entries, %zu bytes -> %llu bytes\n", output, sources.size(), total,
+                static_cast<unsigned long long>(fs::file_size(output)));
+    return 0;
+}
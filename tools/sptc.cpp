@@ -0,0 +1,105 @@
+/**
+ *  sptc - offline texture compressor..
+ *
+ *  converts an image (png, tga, bmp, jpg, ..) into an 'SPTC' container with
+ *  a full, pre-filtered mip chain, readable by Texture::loadFromFile/loadFromCompressed.
+ *
+ *  build:
+ *      c++ -std=c++14 -Iinclude tools/sptc.cpp -o sptc -lsp
+ *
+ *  usage:
+ *      sptc [-f dxt1|dxt3|dxt5|bc7] [--no-mips] input output.sptc
+ */
+#include <sp/gxsp/compressed_image.h>
+#include <cstdio>
+#include <cstring>
+
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+namespace
+{
+    void usage()
+    {
+        std::fprintf(stderr, "usage: sptc [-f dxt1|dxt3|dxt5|bc7] [--no-mips] input output.sptc\n");
+    }
+
+    bool parse_format(const char* name, sp::CompressedImage::SP_Format& format)
+    {
+        if(!std::strcmp(name, "dxt1")) { format = sp::CompressedImage::DXT1; return true; }
+        if(!std::strcmp(name, "dxt3")) { format = sp::CompressedImage::DXT3; return true; }
+        if(!std::strcmp(name, "dxt5")) { format = sp::CompressedImage::DXT5; return true; }
+        if(!std::strcmp(name, "bc7"))  { format = sp::CompressedImage::BC7;  return true; }
+        return false;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    sp::CompressedImage::SP_Format format = sp::CompressedImage::DXT5;
+    bool mipmaps = true;
+    const char* input  = nullptr;
+    const char* output = nullptr;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if(!std::strcmp(argv[i], "-f") && i + 1 < argc)
+        {
+            if(!parse_format(argv[++i], format))
+            {
+                std::fprintf(stderr, "sptc: unknown format %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if(!std::strcmp(argv[i], "--no-mips"))
+        {
+            mipmaps = false;
+        }
+        else if(!input)
+        {
+            input = argv[i];
+        }
+        else if(!output)
+        {
+            output = argv[i];
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    if(!input || !output)
+    {
+        usage();
+        return 1;
+    }
+
+    int width    = 0;
+    int height   = 0;
+    int channels = 0;
+    unsigned char* pixels = stbi_load(input, &width, &height, &channels, 4);
+    if(!pixels)
+    {
+        std::fprintf(stderr, "sptc: failed to load %s (%s)\n", input, stbi_failure_reason());
+        return 1;
+    }
+
+    std::vector<SPuint8> container = sp::CompressedImage::createContainer(format, pixels, width, height, mipmaps);
+    stbi_image_free(pixels);
+
+    std::FILE* file = std::fopen(output, "wb");
+    if(!file || std::fwrite(container.data(), 1, container.size(), file) != container.size())
+    {
+        std::fprintf(stderr, "sptc: failed to write %s\n", output);
+        if(file)
+            std::fclose(file);
+        return 1;
+    }
+    std::fclose(file);
+
+    std::printf("%s: %dx%d -> %zu bytes\n", output, width, height, container.size());
+    return 0;
+}